@@ -0,0 +1,227 @@
+/** @file BidirectionalSolver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour solver that searches from both ends
+@details A meeting is recorded whenever one side reaches a state the other side already
+holds. Once a whole level has been expanded, every path shorter than the best meeting
+would have had to meet already, so the best meeting is the answer.
+**/
+
+
+#include<climits>
+#include "BidirectionalSolver.h"
+
+using namespace std;
+
+/**
+* BidirectionalSolver constructor
+*
+*@pre none
+*
+*@post an idle solver
+*
+**/
+BidirectionalSolver::BidirectionalSolver(){
+    numCars = 0;
+    cancel = NULL;
+    fillArray(board);
+}
+
+/**
+* setCancel  method that lets another thread stop later searches
+*
+*@return void
+*
+*@param cancel flag checked at every state expanded, NULL to never stop early
+*
+**/
+void BidirectionalSolver::setCancel(const atomic<bool>* cancel){
+    this->cancel = cancel;
+}
+
+/**
+* place  method that moves the scratch vehicles to the offsets of a key
+*
+*@return StateKey the key
+*
+*@param key a packed state of the scenario
+*
+*@post scratch vehicles and board describe the state
+*
+**/
+StateKey BidirectionalSolver::place(StateKey key){
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        int offset = (int)((key >> (KEY_BITS * i)) & 7);
+        if(isHorizontal(cars[i])){
+            cars[i].column = offset;
+        }
+        else{
+            cars[i].row = offset;
+        }
+        setBoard(board, cars[i], i + 1);
+    }
+    return key;
+}
+
+/**
+* seedGoals  method that lists every goal state: car 0 at the exit and the other vehicles
+* at every offset where they fit, placed one vehicle at a time
+*
+*@return bool false once there are more than BIDIRECTIONAL_MAX_GOALS goal states
+*
+*@param vehicle the next vehicle to place
+*
+*@param key the offsets of the vehicles placed so far
+*
+*@pre vehicles before vehicle are on the scratch board
+*
+*@post goal states are in backward and backwardLevel
+*
+**/
+bool BidirectionalSolver::seedGoals(int vehicle, StateKey key){
+    if(vehicle == numCars){
+        if(backward.insert(make_pair(key, 0)).second){
+            backwardLevel.push_back(key);
+        }
+        return backwardLevel.size() <= BIDIRECTIONAL_MAX_GOALS;
+    }
+    Vehicle& v = cars[vehicle];
+    int first = vehicle == 0 ? MAX_ARR - v.length : 0;
+    for(int offset = first; offset <= MAX_ARR - v.length; offset++){
+        if(isHorizontal(v)){
+            v.column = offset;
+        }
+        else{
+            v.row = offset;
+        }
+        bool free = true;
+        for(int k = 0; k < v.length && free; k++){
+            free = (isHorizontal(v) ? board[v.row][v.column + k] : board[v.row + k][v.column]) == 0;
+        }
+        if(!free){
+            continue;
+        }
+        setBoard(board, v, vehicle + 1);
+        bool fits = seedGoals(vehicle + 1, key | (StateKey)offset << (KEY_BITS * vehicle));
+        setBoard(board, v, 0);
+        if(!fits){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* expand  method that expands one whole level of one side
+*
+*@return bool false if the search was cancelled
+*
+*@param level the side's frontier, replaced by the following level
+*
+*@param mine the side's distances
+*
+*@param other the other side's distances
+*
+*@param depth distance of the states in level
+*
+*@param best lowered to the shortest path through any meeting found
+*
+**/
+bool BidirectionalSolver::expand(vector<StateKey>& level, unordered_map<StateKey, int>& mine,
+                                 const unordered_map<StateKey, int>& other, int depth, int& best){
+    next.clear();
+    for(size_t f = 0; f < level.size(); f++){
+        if(cancel != NULL && cancel->load(memory_order_relaxed)){
+            return false;
+        }
+        StateKey key = place(level[f]);
+        for(int i = 0; i < numCars; i++){
+            StateKey step = StateKey(1) << (KEY_BITS * i);
+            StateKey children[2];
+            int count = 0;
+            if(moveForward(cars[i], board)){
+                children[count++] = key + step;
+                moveBackward(cars[i], board);
+            }
+            if(moveBackward(cars[i], board)){
+                children[count++] = key - step;
+                moveForward(cars[i], board);
+            }
+            for(int c = 0; c < count; c++){
+                if(!mine.insert(make_pair(children[c], depth + 1)).second){
+                    continue;
+                }
+                next.push_back(children[c]);
+                unordered_map<StateKey, int>::const_iterator met = other.find(children[c]);
+                if(met != other.end() && depth + 1 + met->second < best){
+                    best = depth + 1 + met->second;
+                }
+            }
+        }
+    }
+    level.swap(next);
+    return true;
+}
+
+/**
+*solve  method that searches from the scenario and from every goal state until the two
+*searches meet
+*
+*@return SolveStatus exact, unsolvable, or bounded if the scenario was declined or the
+*search was cancelled
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when exact
+*
+*@pre vehicles that do not overlap
+*
+*@post the distance maps hold the search until the next solve
+*
+**/
+SolveStatus BidirectionalSolver::solve(const Vehicle cars[], const int numCars, int& moves){
+    this->numCars = numCars;
+    forward.clear();
+    backward.clear();
+    forwardLevel.clear();
+    backwardLevel.clear();
+    StateKey start = 0;
+    for(int i = 0; i < numCars; i++){
+        this->cars[i] = cars[i];
+        start |= (StateKey)(isHorizontal(cars[i]) ? cars[i].column : cars[i].row) << (KEY_BITS * i);
+    }
+    if(isProvenUnsolvable(cars, numCars)){
+        return SOLVE_UNSOLVABLE;
+    }
+    fillArray(board);
+    if(!seedGoals(0, 0)){
+        return SOLVE_BOUNDED;
+    }
+    if(backward.count(start) != 0){
+        moves = 0;
+        return SOLVE_EXACT;
+    }
+    forward[start] = 0;
+    forwardLevel.push_back(start);
+
+    int forwardDepth = 0;
+    int backwardDepth = 0;
+    int best = INT_MAX;
+    while(!forwardLevel.empty() && !backwardLevel.empty()){
+        bool finished = forwardLevel.size() <= backwardLevel.size() ?
+            expand(forwardLevel, forward, backward, forwardDepth++, best) :
+            expand(backwardLevel, backward, forward, backwardDepth++, best);
+        if(!finished){
+            return SOLVE_BOUNDED;
+        }
+        if(best != INT_MAX){
+            moves = best;
+            return SOLVE_EXACT;
+        }
+    }
+    //one side ran out of states without meeting the other
+    return SOLVE_UNSOLVABLE;
+}
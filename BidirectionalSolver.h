@@ -0,0 +1,49 @@
+/** @file BidirectionalSolver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour solver that searches from both ends
+@details Runs one BFS forward from the scenario and one backward from every goal state,
+always expanding the smaller frontier by a whole level. Moves can be undone, so the
+backward search uses the same move rules. Deep puzzles meet in the middle after far fewer
+states than a one sided BFS, but seeding needs every goal state, so scenarios with more
+than BIDIRECTIONAL_MAX_GOALS of them are declined.
+**/
+
+#ifndef BIDIRECTIONAL_SOLVER_H
+#define BIDIRECTIONAL_SOLVER_H
+
+#include<vector>
+#include<atomic>
+#include<unordered_map>
+#include "Solver.h"
+
+const size_t BIDIRECTIONAL_MAX_GOALS = 1 << 18;
+
+/**
+* BidirectionalSolver reusable meet in the middle BFS
+**/
+class BidirectionalSolver{
+public:
+    BidirectionalSolver();
+    void setCancel(const std::atomic<bool>* cancel);
+    SolveStatus solve(const Vehicle cars[], const int numCars, int& moves);
+
+private:
+    bool seedGoals(int vehicle, StateKey key);
+    StateKey place(StateKey key);
+    bool expand(std::vector<StateKey>& level, std::unordered_map<StateKey, int>& mine,
+                const std::unordered_map<StateKey, int>& other, int depth, int& best);
+
+    Vehicle cars[MAX_VEHICLE];      //scratch vehicles for the state being expanded
+    int board[MAX_ARR][MAX_ARR];    //scratch board for the state being expanded
+    int numCars;
+
+    std::unordered_map<StateKey, int> forward;    //distance from the scenario
+    std::unordered_map<StateKey, int> backward;   //distance to the nearest goal
+    std::vector<StateKey> forwardLevel;
+    std::vector<StateKey> backwardLevel;
+    std::vector<StateKey> next;
+    const std::atomic<bool>* cancel;  //set by another thread to stop the search, may be NULL
+};
+
+#endif
@@ -0,0 +1,280 @@
+/** @file Checkpoint.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif saves and restores BFS searches so they survive being stopped
+@details File layout: a CheckpointHeader, then the sorted frontier ranks and the sorted
+visited ranks, each stored as the difference from the rank before it in 7 bit groups
+with the high bit set on every group but the last. Neighbouring states have close ranks,
+so most visited states take one or two bytes. A checkpoint is written to a temporary
+file that is synced and renamed over the old one once complete, and the directory is
+synced after the rename, so a search stopped mid write, or a crash, still leaves the
+previous checkpoint behind. A checkpoint is only read back if its scenario is valid,
+every rank lies in that scenario's rank range and the frontier is part of the visited
+states.
+**/
+
+
+#include<iostream>
+#include<fstream>
+#include<algorithm>
+#include<cstdio>
+#include<cstring>
+#include<unistd.h>
+#include<fcntl.h>
+#include "Solver.h"
+
+using namespace std;
+
+struct CheckpointHeader{
+    char magic[8];
+    uint32_t numCars;
+    int32_t depth;
+    uint64_t numFrontier;
+    uint64_t numVisited;
+    int32_t vehicles[MAX_VEHICLE][4];   //length, orientation, row, column
+};
+
+/**
+* writeRanks  method that sorts ranks and writes them as deltas
+*
+*@return void
+*
+*@param out file being written
+*
+*@param ranks distinct ranks, sorted in place
+*
+**/
+static void writeRanks(ofstream& out, vector<uint64_t>& ranks){
+    sort(ranks.begin(), ranks.end());
+    vector<uint8_t> chunk;
+    chunk.reserve(1 << 16);
+    uint64_t previous = 0;
+    for(size_t i = 0; i < ranks.size(); i++){
+        uint64_t delta = ranks[i] - previous;
+        previous = ranks[i];
+        while(delta >= 0x80){
+            chunk.push_back((uint8_t)(delta | 0x80));
+            delta >>= 7;
+        }
+        chunk.push_back((uint8_t)delta);
+        if(chunk.size() >= (1 << 16) - 10){
+            out.write((const char*)&chunk[0], chunk.size());
+            chunk.clear();
+        }
+    }
+    if(!chunk.empty()){
+        out.write((const char*)&chunk[0], chunk.size());
+    }
+}
+
+/**
+* readRanks  method that reads ranks written by writeRanks
+*
+*@return bool indicating every rank was read
+*
+*@param in file being read
+*
+*@param count number of ranks
+*
+*@param limit every rank must be below it
+*
+*@param ranks replaced with the ranks
+*
+**/
+static bool readRanks(ifstream& in, uint64_t count, uint64_t limit, vector<uint64_t>& ranks){
+    ranks.clear();
+    uint64_t value = 0;
+    for(uint64_t i = 0; i < count; i++){
+        uint64_t delta = 0;
+        int shift = 0;
+        int byte = 0;
+        while((byte = in.get()) != EOF && (byte & 0x80) && shift < 63){
+            delta |= (uint64_t)(byte & 0x7f) << shift;
+            shift += 7;
+        }
+        if(byte == EOF || (byte & 0x80)){
+            return false;
+        }
+        delta |= (uint64_t)byte << shift;
+        //checked before adding so a huge delta cannot wrap back into range
+        if(delta >= limit - value){
+            return false;
+        }
+        value += delta;
+        ranks.push_back(value);
+    }
+    return true;
+}
+
+/**
+* syncPath  method that flushes a file or a directory to disk
+*
+*@return bool indicating it was synced
+*
+*@param path file or directory to sync
+*
+*@param directory whether path is a directory
+*
+**/
+static bool syncPath(const string& path, bool directory){
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | (directory ? O_DIRECTORY : 0));
+    if(fd < 0){
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+/**
+* writeCheckpoint  method that saves a checkpoint, replacing any earlier one at the path
+*
+*@return bool indicating the file was written
+*
+*@param path file to write
+*
+*@param checkpoint the search to save; its rank lists are sorted
+*
+**/
+bool writeCheckpoint(const string& path, Checkpoint& checkpoint){
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.numCars = checkpoint.numCars;
+    header.depth = checkpoint.depth;
+    header.numFrontier = checkpoint.frontier.size();
+    header.numVisited = checkpoint.visited.size();
+    for(int i = 0; i < checkpoint.numCars; i++){
+        header.vehicles[i][0] = checkpoint.cars[i].length;
+        header.vehicles[i][1] = checkpoint.cars[i].orientation;
+        header.vehicles[i][2] = checkpoint.cars[i].row;
+        header.vehicles[i][3] = checkpoint.cars[i].column;
+    }
+
+    string temporary = path + ".tmp";
+    {
+        ofstream out(temporary.c_str(), ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        writeRanks(out, checkpoint.frontier);
+        writeRanks(out, checkpoint.visited);
+        out.flush();
+        if(!out){
+            remove(temporary.c_str());
+            return false;
+        }
+    }
+    //the data must be on disk before the rename can point the path at it
+    if(!syncPath(temporary, false)){
+        remove(temporary.c_str());
+        return false;
+    }
+    if(rename(temporary.c_str(), path.c_str()) != 0){
+        return false;
+    }
+    size_t slash = path.rfind('/');
+    return syncPath(slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash), true);
+}
+
+/**
+* readCheckpoint  method that loads a checkpoint written by writeCheckpoint
+*
+*@return bool indicating a complete checkpoint was read
+*
+*@param path file to read
+*
+*@param checkpoint replaced with the saved search
+*
+**/
+bool readCheckpoint(const string& path, Checkpoint& checkpoint){
+    ifstream in(path.c_str(), ios::binary);
+    CheckpointHeader header;
+    if(!in.read((char*)&header, sizeof(header)) ||
+       memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+       header.numCars < 1 || header.numCars > (uint32_t)MAX_VEHICLE || header.depth < 1){
+        return false;
+    }
+    checkpoint.numCars = header.numCars;
+    checkpoint.depth = header.depth;
+    for(int i = 0; i < checkpoint.numCars; i++){
+        checkpoint.cars[i].length = header.vehicles[i][0];
+        checkpoint.cars[i].orientation = (char)header.vehicles[i][1];
+        checkpoint.cars[i].row = header.vehicles[i][2];
+        checkpoint.cars[i].column = header.vehicles[i][3];
+    }
+    if(!isValidScenario(checkpoint.cars, checkpoint.numCars)){
+        return false;
+    }
+    //ranks are mixed radix over each vehicle's offsets, so they stay below this
+    uint64_t numStates = 1;
+    for(int i = 0; i < checkpoint.numCars; i++){
+        numStates *= MAX_ARR - checkpoint.cars[i].length + 1;
+    }
+    if(header.numFrontier > header.numVisited || header.numVisited > numStates ||
+       !readRanks(in, header.numFrontier, numStates, checkpoint.frontier) ||
+       !readRanks(in, header.numVisited, numStates, checkpoint.visited)){
+        return false;
+    }
+    //both lists are sorted, so one merge shows every frontier state was visited
+    return includes(checkpoint.visited.begin(), checkpoint.visited.end(),
+                    checkpoint.frontier.begin(), checkpoint.frontier.end());
+}
+
+/**
+* CheckpointWriter constructor
+*
+*@pre none
+*
+*@post a writer with nothing to write
+*
+**/
+CheckpointWriter::CheckpointWriter(){
+    pending.numCars = 0;
+    pending.depth = 0;
+}
+
+/**
+* CheckpointWriter destructor that lets the last checkpoint finish
+**/
+CheckpointWriter::~CheckpointWriter(){
+    wait();
+}
+
+/**
+* wait  method that blocks until the checkpoint being written is on disk
+*
+*@return void
+*
+**/
+void CheckpointWriter::wait(){
+    if(worker.joinable()){
+        worker.join();
+    }
+}
+
+/**
+* write  method that starts writing a checkpoint once the previous one is done
+*
+*@return void
+*
+*@param path file to write
+*
+*@param checkpoint the search to save; swapped with the previous checkpoint so its buffers
+*are reused for the next one
+*
+**/
+void CheckpointWriter::write(const string& path, Checkpoint& checkpoint){
+    wait();
+    this->path = path;
+    pending.numCars = checkpoint.numCars;
+    pending.depth = checkpoint.depth;
+    for(int i = 0; i < checkpoint.numCars; i++){
+        pending.cars[i] = checkpoint.cars[i];
+    }
+    pending.frontier.swap(checkpoint.frontier);
+    pending.visited.swap(checkpoint.visited);
+    worker = thread([this](){
+        if(!writeCheckpoint(this->path, pending)){
+            cerr << "cannot write checkpoint " << this->path << endl;
+        }
+    });
+}
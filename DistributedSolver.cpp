@@ -0,0 +1,742 @@
+/** @file DistributedSolver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour BFS spread over several processes
+@details A worker never blocks on a send: while its bytes for a peer wait it keeps
+reading from every peer, so two workers flooding each other cannot deadlock. A worker
+that loses a peer stops the level and says so in its report; every worker is connected
+to the lost one, so all of them notice, and the coordinator shuts the rest down. See
+DistributedSolver.h for the protocol.
+**/
+
+
+#include<iostream>
+#include<cerrno>
+#include<cstring>
+#include<cstdlib>
+#include<unistd.h>
+#include<fcntl.h>
+#include<poll.h>
+#include<sys/socket.h>
+#include<sys/wait.h>
+#include "DistributedSolver.h"
+
+using namespace std;
+
+/**
+* writeAll  method that writes a whole buffer to a blocking socket
+*
+*@return bool indicating every byte was written
+*
+**/
+static bool writeAll(int fd, const void* data, size_t size){
+    const char* p = (const char*)data;
+    while(size > 0){
+        ssize_t written = send(fd, p, size, MSG_NOSIGNAL);
+        if(written < 0 && errno == EINTR){
+            continue;
+        }
+        if(written <= 0){
+            return false;
+        }
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+/**
+* readAll  method that fills a whole buffer from a blocking descriptor
+*
+*@return bool indicating every byte was read
+*
+**/
+static bool readAll(int fd, void* data, size_t size){
+    char* p = (char*)data;
+    while(size > 0){
+        ssize_t got = read(fd, p, size);
+        if(got < 0 && errno == EINTR){
+            continue;
+        }
+        if(got <= 0){
+            return false;
+        }
+        p += got;
+        size -= got;
+    }
+    return true;
+}
+
+/**
+* ownerOf  method that picks the worker a state belongs to
+*
+*@return int the worker's index
+*
+*@param key a packed state
+*
+*@param numWorkers number of workers
+*
+**/
+static int ownerOf(StateKey key, int numWorkers){
+    return (int)(((key * 0x9E3779B97F4A7C15ULL) >> 32) % (uint64_t)numWorkers);
+}
+
+struct Peer{
+    int fd;
+    std::vector<StateKey> batch;    //keys not yet framed
+    std::vector<uint8_t> out;       //framed bytes not yet written
+    size_t sent;                    //bytes of out already written
+    std::vector<uint8_t> in;        //bytes read but not yet parsed
+    size_t parsed;                  //bytes of in already parsed
+    bool ended;                     //the peer's end of level marker arrived
+};
+
+/**
+* Partition one worker process's share of the search
+**/
+class Partition{
+public:
+    Partition(int id, int numWorkers, int control, const vector<int>& peerFds);
+    void run();
+
+private:
+    void load(const DistributedCommand& command);
+    void place(StateKey key);
+    bool expandLevel();
+    void route(StateKey key);
+    void deliver(StateKey key);
+    void frame(int p, bool last);
+    void pump(bool wait);
+    void parse(int p);
+    void finishLevel();
+
+    int id;
+    int numWorkers;
+    int control;
+    vector<Peer> peers;             //indexed by worker, this worker's own entry is unused
+    VehicleTable table;
+    int numCars;
+    uint8_t offset[MAX_VEHICLE];    //scratch offsets of the state being expanded
+    uint8_t board[MAX_ARR * MAX_ARR];
+    VisitedTable visited;
+    FrontierBuffer frontier;        //keys this worker owns at the current level
+    FrontierBuffer next;
+    RankBlock block;
+    bool broken;                    //a peer died, so no level can complete any more
+};
+
+/**
+* Partition constructor
+*
+*@param id this worker's index
+*
+*@param numWorkers number of workers
+*
+*@param control socket to the coordinator
+*
+*@param peerFds socket to every other worker, -1 at this worker's own index
+*
+**/
+Partition::Partition(int id, int numWorkers, int control, const vector<int>& peerFds){
+    this->id = id;
+    this->numWorkers = numWorkers;
+    this->control = control;
+    numCars = 0;
+    broken = false;
+    peers.resize(numWorkers);
+    for(int p = 0; p < numWorkers; p++){
+        peers[p].fd = peerFds[p];
+        peers[p].sent = 0;
+        peers[p].parsed = 0;
+        peers[p].ended = false;
+        if(peers[p].fd >= 0){
+            fcntl(peers[p].fd, F_SETFL, fcntl(peers[p].fd, F_GETFL) | O_NONBLOCK);
+        }
+    }
+}
+
+/**
+* run  method that serves scenarios until the coordinator says to quit
+*
+*@return void
+*
+**/
+void Partition::run(){
+    DistributedCommand command;
+    while(readAll(control, &command, sizeof(command)) && command.order != DISTRIBUTED_QUIT){
+        if(command.order != DISTRIBUTED_SCENARIO){
+            continue;
+        }
+        load(command);
+        while(true){
+            DistributedReport report;
+            memset(&report, 0, sizeof(report));
+            report.goal = expandLevel();
+            finishLevel();
+            report.failed = broken;
+            report.added = next.size();
+            report.visited = visited.size();
+            next.finish();
+            frontier.swap(next);
+            next.clear();
+            if(!writeAll(control, &report, sizeof(report)) || !readAll(control, &command, sizeof(command)) ||
+               command.order != DISTRIBUTED_CONTINUE){
+                break;
+            }
+        }
+        if(command.order == DISTRIBUTED_QUIT){
+            break;
+        }
+    }
+}
+
+/**
+* load  method that starts a scenario, the start state going to its owner
+*
+*@return void
+*
+*@param command the scenario
+*
+**/
+void Partition::load(const DistributedCommand& command){
+    visited.clear();
+    frontier.clear();
+    next.clear();
+    numCars = command.numCars;
+    StateKey start = 0;
+    for(int i = 0; i < numCars; i++){
+        bool horizontal = command.vehicles[i][1] == HORIZONTAL;
+        table.length[i] = command.vehicles[i][0];
+        table.radix[i] = MAX_ARR - table.length[i] + 1;
+        table.base[i] = horizontal ? command.vehicles[i][2] * MAX_ARR : command.vehicles[i][3];
+        table.stride[i] = horizontal ? 1 : MAX_ARR;
+        start |= (StateKey)(horizontal ? command.vehicles[i][3] : command.vehicles[i][2]) << (KEY_BITS * i);
+    }
+    if(ownerOf(start, numWorkers) == id){
+        visited.insert(start);
+        frontier.push(start);
+    }
+}
+
+/**
+* place  method that lays a state out on the scratch offsets and board
+*
+*@return void
+*
+*@param key a packed state of the current scenario
+*
+**/
+void Partition::place(StateKey key){
+    memset(board, 0, sizeof(board));
+    for(int i = 0; i < numCars; i++){
+        offset[i] = (uint8_t)((key >> (KEY_BITS * i)) & 7);
+        for(int k = 0; k < table.length[i]; k++){
+            board[table.base[i] + (offset[i] + k) * table.stride[i]] = i + 1;
+        }
+    }
+}
+
+/**
+* expandLevel  method that routes every child of this worker's frontier to its owner
+*
+*@return bool indicating a child is a goal, which ends the expansion early
+*
+**/
+bool Partition::expandLevel(){
+    for(size_t b = 0; b < frontier.blockCount(); b++){
+        frontier.readBlock(b, block);
+        for(size_t f = 0; f < block.size(); f++){
+            StateKey key = block[f];
+            place(key);
+            for(int i = 0; i < numCars; i++){
+                StateKey step = StateKey(1) << (KEY_BITS * i);
+                int end = offset[i] + table.length[i];
+                if(end < MAX_ARR && board[table.base[i] + end * table.stride[i]] == 0){
+                    //a goal is never visited, since the search would have stopped there
+                    if(i == 0 && end + 1 == MAX_ARR){
+                        return true;
+                    }
+                    route(key + step);
+                }
+                if(offset[i] > 0 && board[table.base[i] + (offset[i] - 1) * table.stride[i]] == 0){
+                    route(key - step);
+                }
+            }
+        }
+        pump(false);
+        if(broken){
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+* route  method that sends a child to its owner, or takes it when this worker owns it
+*
+*@return void
+*
+*@param key the child
+*
+**/
+void Partition::route(StateKey key){
+    int owner = ownerOf(key, numWorkers);
+    if(owner == id){
+        deliver(key);
+        return;
+    }
+    Peer& peer = peers[owner];
+    peer.batch.push_back(key);
+    if(peer.batch.size() >= DISTRIBUTED_BATCH){
+        frame(owner, false);
+        pump(false);
+        //keep reading while a slow peer drains, so the senders never wait on each other
+        while(!broken && peer.out.size() - peer.sent > DISTRIBUTED_BACKLOG){
+            pump(true);
+        }
+    }
+}
+
+/**
+* deliver  method that takes a child this worker owns into the next level if it is new
+*
+*@return void
+*
+*@param key the child
+*
+**/
+void Partition::deliver(StateKey key){
+    if(visited.insert(key)){
+        next.push(key);
+    }
+}
+
+/**
+* frame  method that moves a peer's batched keys into its output as one message
+*
+*@return void
+*
+*@param p the peer
+*
+*@param last whether to follow them with the end of level marker
+*
+**/
+void Partition::frame(int p, bool last){
+    Peer& peer = peers[p];
+    if(peer.sent == peer.out.size()){
+        peer.out.clear();
+        peer.sent = 0;
+    }
+    if(!peer.batch.empty()){
+        uint32_t count = (uint32_t)peer.batch.size();
+        const uint8_t* keys = (const uint8_t*)&peer.batch[0];
+        peer.out.insert(peer.out.end(), (const uint8_t*)&count, (const uint8_t*)&count + sizeof(count));
+        peer.out.insert(peer.out.end(), keys, keys + count * sizeof(StateKey));
+        peer.batch.clear();
+    }
+    if(last){
+        uint32_t count = 0;
+        peer.out.insert(peer.out.end(), (const uint8_t*)&count, (const uint8_t*)&count + sizeof(count));
+    }
+}
+
+/**
+* pump  method that writes what the peers can take and reads whatever they sent
+*
+*@return void
+*
+*@param wait whether to block until some peer is ready
+*
+**/
+void Partition::pump(bool wait){
+    if(broken){
+        return;
+    }
+    vector<pollfd> ready;
+    vector<int> which;
+    for(int p = 0; p < numWorkers; p++){
+        if(p == id){
+            continue;
+        }
+        pollfd entry;
+        entry.fd = peers[p].fd;
+        entry.events = POLLIN | (peers[p].sent < peers[p].out.size() ? POLLOUT : 0);
+        entry.revents = 0;
+        ready.push_back(entry);
+        which.push_back(p);
+    }
+    if(ready.empty() || poll(&ready[0], ready.size(), wait ? -1 : 0) <= 0){
+        return;
+    }
+    char buffer[1 << 16];
+    for(size_t r = 0; r < ready.size(); r++){
+        Peer& peer = peers[which[r]];
+        if(ready[r].revents & POLLOUT){
+            ssize_t written = send(peer.fd, &peer.out[peer.sent], peer.out.size() - peer.sent, MSG_NOSIGNAL);
+            if(written > 0){
+                peer.sent += written;
+            }
+            else if(written < 0 && errno != EAGAIN && errno != EINTR){
+                broken = true;
+                return;
+            }
+        }
+        if(ready[r].revents & (POLLIN | POLLHUP | POLLERR)){
+            ssize_t got = recv(peer.fd, buffer, sizeof(buffer), 0);
+            if(got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)){
+                //a peer died, so this level can never finish
+                broken = true;
+                return;
+            }
+            if(got > 0){
+                peer.in.insert(peer.in.end(), buffer, buffer + got);
+                parse(which[r]);
+            }
+        }
+    }
+}
+
+/**
+* parse  method that delivers every complete message a peer sent this level
+*
+*@return void
+*
+*@param p the peer
+*
+**/
+void Partition::parse(int p){
+    Peer& peer = peers[p];
+    while(!peer.ended && peer.in.size() - peer.parsed >= sizeof(uint32_t)){
+        uint32_t count = 0;
+        memcpy(&count, &peer.in[peer.parsed], sizeof(count));
+        if(count == 0){
+            peer.parsed += sizeof(count);
+            peer.ended = true;
+            break;
+        }
+        size_t length = sizeof(count) + count * sizeof(StateKey);
+        if(peer.in.size() - peer.parsed < length){
+            break;
+        }
+        for(uint32_t k = 0; k < count; k++){
+            StateKey key;
+            memcpy(&key, &peer.in[peer.parsed + sizeof(count) + k * sizeof(StateKey)], sizeof(key));
+            deliver(key);
+        }
+        peer.parsed += length;
+    }
+    if(peer.parsed == peer.in.size()){
+        peer.in.clear();
+        peer.parsed = 0;
+    }
+}
+
+/**
+* finishLevel  method that flushes every batch with an end of level marker and takes
+* children until every peer has ended its level
+*
+*@return void
+*
+*@post next holds every new state this worker owns at the following level
+*
+**/
+void Partition::finishLevel(){
+    for(int p = 0; p < numWorkers; p++){
+        if(p != id){
+            frame(p, true);
+        }
+    }
+    while(true){
+        bool done = true;
+        for(int p = 0; p < numWorkers; p++){
+            if(p != id && (!peers[p].ended || peers[p].sent < peers[p].out.size())){
+                done = false;
+            }
+        }
+        if(done || broken){
+            break;
+        }
+        pump(true);
+    }
+    //no peer starts the next level before every worker has reported this one to the
+    //coordinator, so nothing can have come in behind the marker
+    for(int p = 0; p < numWorkers; p++){
+        peers[p].ended = false;
+    }
+}
+
+/**
+* DistributedSolver constructor
+*
+*@pre none
+*
+*@post a coordinator with no workers
+*
+**/
+DistributedSolver::DistributedSolver(){
+    states = 0;
+    lost = false;
+}
+
+/**
+* DistributedSolver destructor that shuts the workers down
+**/
+DistributedSolver::~DistributedSolver(){
+    stop();
+}
+
+/**
+* closeAll  method that closes every descriptor in a list that is open
+*
+*@return void
+*
+*@param fds descriptors, -1 for ones never opened; all are -1 afterwards
+*
+**/
+static void closeAll(vector<int>& fds){
+    for(size_t i = 0; i < fds.size(); i++){
+        if(fds[i] >= 0){
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+/**
+* start  method that forks the workers and connects them
+*
+*@return bool indicating every worker is up; if not, whatever was started is shut down
+*
+*@param numProcesses number of workers
+*
+*@post workers waiting for a scenario
+*
+**/
+bool DistributedSolver::start(int numProcesses){
+    stop();
+    lost = false;
+    if(numProcesses < 1){
+        return false;
+    }
+    //mesh[i][j] is worker i's end of its socket to worker j
+    vector<vector<int> > mesh(numProcesses, vector<int>(numProcesses, -1));
+    vector<int> theirs(numProcesses, -1);
+    for(int i = 0; i < numProcesses; i++){
+        for(int j = i + 1; j < numProcesses; j++){
+            int pair[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0){
+                abandon(mesh, theirs);
+                return false;
+            }
+            mesh[i][j] = pair[0];
+            mesh[j][i] = pair[1];
+        }
+        int pair[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0){
+            abandon(mesh, theirs);
+            return false;
+        }
+        control.push_back(pair[0]);
+        theirs[i] = pair[1];
+    }
+    for(int i = 0; i < numProcesses; i++){
+        pid_t pid = fork();
+        if(pid < 0){
+            abandon(mesh, theirs);
+            return false;
+        }
+        if(pid == 0){
+            //keep only this worker's sockets
+            for(int a = 0; a < numProcesses; a++){
+                close(control[a]);
+                if(a != i){
+                    close(theirs[a]);
+                }
+                for(int b = 0; b < numProcesses; b++){
+                    if(a != i && mesh[a][b] >= 0){
+                        close(mesh[a][b]);
+                    }
+                }
+            }
+            Partition partition(i, numProcesses, theirs[i], mesh[i]);
+            partition.run();
+            _exit(0);
+        }
+        workers.push_back(pid);
+    }
+    closeAll(theirs);
+    for(int i = 0; i < numProcesses; i++){
+        closeAll(mesh[i]);
+    }
+    return true;
+}
+
+/**
+* abandon  method that undoes a start that failed partway
+*
+*@return void
+*
+*@param mesh the worker sockets opened so far
+*
+*@param theirs the workers' ends of the control sockets opened so far
+*
+*@post every descriptor is closed and the workers already forked have quit
+*
+**/
+void DistributedSolver::abandon(vector<vector<int> >& mesh, vector<int>& theirs){
+    closeAll(theirs);
+    for(size_t i = 0; i < mesh.size(); i++){
+        closeAll(mesh[i]);
+    }
+    stop();
+}
+
+/**
+* broadcast  method that sends one command to every worker
+*
+*@return bool indicating every worker took it
+*
+*@param command the command
+*
+**/
+bool DistributedSolver::broadcast(const DistributedCommand& command){
+    for(size_t w = 0; w < control.size(); w++){
+        if(!writeAll(control[w], &command, sizeof(command))){
+            return fail(w);
+        }
+    }
+    return true;
+}
+
+/**
+* fail  method that gives up on the workers once one of them is gone
+*
+*@return bool always false, for the caller to pass on
+*
+*@param w the worker found missing or reporting a lost peer
+*
+*@post every worker has quit and failed() is true
+*
+**/
+bool DistributedSolver::fail(size_t w){
+    cerr << "distributed worker " << w << " lost its connection, stopping the workers" << endl;
+    stop();
+    lost = true;
+    return false;
+}
+
+/**
+* failed  method that tells whether the workers were lost
+*
+*@return bool true once a worker died; solve answers nothing until start runs again
+*
+**/
+bool DistributedSolver::failed() const{
+    return lost;
+}
+
+/**
+* stop  method that tells the workers to quit and waits for them
+*
+*@return void
+*
+**/
+void DistributedSolver::stop(){
+    DistributedCommand command;
+    memset(&command, 0, sizeof(command));
+    command.order = DISTRIBUTED_QUIT;
+    for(size_t w = 0; w < control.size(); w++){
+        writeAll(control[w], &command, sizeof(command));
+        close(control[w]);
+    }
+    for(size_t w = 0; w < workers.size(); w++){
+        waitpid(workers[w], NULL, 0);
+    }
+    control.clear();
+    workers.clear();
+}
+
+/**
+* statesVisited  method that reports how many states the last solve discovered
+*
+*@return size_t states held by every worker together
+*
+**/
+size_t DistributedSolver::statesVisited() const{
+    return states;
+}
+
+/**
+*solve  method that runs the BFS on the workers one level at a time
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@pre vehicles that do not overlap, and started workers
+*
+*@post the workers wait for the next scenario, or were shut down and failed() is true
+*
+**/
+bool DistributedSolver::solve(const Vehicle cars[], const int numCars, int& moves){
+    states = 0;
+    if(lost){
+        return false;
+    }
+    int board[MAX_ARR][MAX_ARR];
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        setBoard(board, cars[i], i + 1);
+    }
+    if(isComplete(cars[0], board)){
+        moves = 0;
+        return true;
+    }
+    if(isProvenUnsolvable(cars, numCars)){
+        return false;
+    }
+
+    DistributedCommand command;
+    memset(&command, 0, sizeof(command));
+    command.order = DISTRIBUTED_SCENARIO;
+    command.numCars = numCars;
+    for(int i = 0; i < numCars; i++){
+        command.vehicles[i][0] = cars[i].length;
+        command.vehicles[i][1] = cars[i].orientation;
+        command.vehicles[i][2] = cars[i].row;
+        command.vehicles[i][3] = cars[i].column;
+    }
+    if(!broadcast(command)){
+        return false;
+    }
+    for(int depth = 1; ; depth++){
+        //every worker reports once its level is complete, which is the barrier
+        uint64_t added = 0;
+        bool goal = false;
+        states = 0;
+        for(size_t w = 0; w < control.size(); w++){
+            DistributedReport report;
+            if(!readAll(control[w], &report, sizeof(report)) || report.failed){
+                return fail(w);
+            }
+            added += report.added;
+            states += report.visited;
+            goal = goal || report.goal != 0;
+        }
+        command.order = goal || added == 0 ? DISTRIBUTED_STOP : DISTRIBUTED_CONTINUE;
+        if(!broadcast(command)){
+            return false;
+        }
+        if(goal){
+            moves = depth;
+            return true;
+        }
+        if(added == 0){
+            return false;
+        }
+    }
+}
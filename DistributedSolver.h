@@ -0,0 +1,78 @@
+/** @file DistributedSolver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour BFS spread over several processes
+@details The calling process coordinates N forked worker processes. Every state belongs to
+the worker its key hashes to, which alone keeps it in its visited table and frontier, so
+each process holds about 1/N of the search. A worker expands its own frontier and routes
+each child to the child's owner in batches of DISTRIBUTED_BATCH keys; after sending an
+end of level marker to every peer and receiving one from each, it reports how many new
+states it took and whether it reached the goal. The coordinator sums the reports and
+either stops every worker or lets them start the next level, which makes every level a
+barrier.
+
+Workers are joined by a full mesh of stream sockets and the coordinator talks to each
+over its own socket. Only start depends on those being Unix socket pairs; everything
+after it reads and writes plain stream descriptors, so TCP connections between hosts
+could be put in their place.
+  data    - uint32 count then count uint64 keys, a count of 0 ends the sender's level
+  control - a DistributedCommand to the worker, a DistributedReport back after each level
+**/
+
+#ifndef DISTRIBUTED_SOLVER_H
+#define DISTRIBUTED_SOLVER_H
+
+#include<vector>
+#include<sys/types.h>
+#include "Solver.h"
+
+//keys per data message
+const size_t DISTRIBUTED_BATCH = 4096;
+
+//pending bytes to one peer before a worker stops expanding until they drain
+const size_t DISTRIBUTED_BACKLOG = 1 << 22;
+
+enum DistributedOrder{ DISTRIBUTED_SCENARIO, DISTRIBUTED_CONTINUE, DISTRIBUTED_STOP, DISTRIBUTED_QUIT };
+
+struct DistributedCommand{
+    int32_t order;
+    int32_t numCars;
+    int32_t vehicles[MAX_VEHICLE][4];   //length, orientation, row, column
+};
+
+struct DistributedReport{
+    uint64_t added;         //new states the worker took this level
+    uint64_t visited;       //states the worker holds
+    int32_t goal;           //the worker reached a goal this level
+    int32_t failed;         //the worker lost a peer, so the level is incomplete
+};
+
+/**
+* DistributedSolver coordinator of a set of BFS worker processes. The workers stay up
+* between scenarios, each keeping its share of the visited table allocated.
+**/
+class DistributedSolver{
+public:
+    DistributedSolver();
+    ~DistributedSolver();
+    bool start(int numProcesses);
+    bool solve(const Vehicle cars[], const int numCars, int& moves);
+    size_t statesVisited() const;
+    bool failed() const;
+
+private:
+    DistributedSolver(const DistributedSolver&);
+    DistributedSolver& operator=(const DistributedSolver&);
+
+    bool broadcast(const DistributedCommand& command);
+    bool fail(size_t w);
+    void abandon(std::vector<std::vector<int> >& mesh, std::vector<int>& theirs);
+    void stop();
+
+    std::vector<int> control;       //socket to each worker
+    std::vector<pid_t> workers;
+    size_t states;                  //states the workers held after the last solve
+    bool lost;                      //a worker died and the rest were shut down
+};
+
+#endif
@@ -0,0 +1,238 @@
+/** @file HugePages.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif huge page backed storage for the solver's large tables
+@details The length of every large block's mapping (0 for the heap) is kept in a table
+beside it rather than in a header, so a power of two table fills its pages exactly and
+hugeDeallocate can free it whatever kind of pages it ended up on, even after the policy
+changed.
+**/
+
+
+#include<new>
+#include<atomic>
+#include<mutex>
+#include<unordered_map>
+#include<stdint.h>
+#include<sys/mman.h>
+#include "HugePages.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+using namespace std;
+
+const size_t PAGE_2MB = (size_t)1 << 21;
+const size_t PAGE_1GB = (size_t)1 << 30;
+
+static atomic<int> policy(HUGE_PAGES_TRANSPARENT);
+
+//mapping length of each large block, 0 for one from the heap, spread over shards by
+//address so workers allocating and freeing at the same time rarely wait on one lock
+const int BLOCK_SHARDS = 16;
+
+struct BlockShard{
+    mutex guard;
+    unordered_map<void*, size_t> lengths;
+};
+
+static BlockShard shards[BLOCK_SHARDS];
+
+//bytes this thread allocated through hugeAllocate and has not freed, and the count it may
+//not pass (0 for none)
+static thread_local size_t allocated = 0;
+static thread_local size_t cap = 0;
+
+/**
+* setHugePagePolicy  method that picks the pages later large allocations ask for
+*
+*@return void
+*
+*@param newPolicy the largest kind of page to try
+*
+**/
+void setHugePagePolicy(HugePagePolicy newPolicy){
+    policy = newPolicy;
+}
+
+/**
+* hugePagePolicy  method that returns the current policy
+*
+*@return HugePagePolicy the largest kind of page tried
+*
+**/
+HugePagePolicy hugePagePolicy(){
+    return (HugePagePolicy)policy.load();
+}
+
+/**
+* mapPages  method that maps anonymous memory, from the huge page pool if asked. A huge
+* page mapping must not pass MAP_NORESERVE: without a reservation mmap succeeds on an
+* empty pool and the first write raises SIGBUS instead of the call failing.
+*
+*@return void* the mapping, NULL if it failed
+*
+*@param length bytes to map, a multiple of the page size asked for
+*
+*@param flags extra mmap flags
+*
+**/
+static void* mapPages(size_t length, int flags){
+    void* p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/**
+* roundUp  method that rounds a size up to a whole number of pages
+*
+*@return size_t the rounded size
+*
+*@param bytes the size
+*
+*@param page a power of two page size
+*
+**/
+static size_t roundUp(size_t bytes, size_t page){
+    return (bytes + page - 1) & ~(page - 1);
+}
+
+/**
+* shardOf  method that finds the shard holding a block's length
+*
+*@return BlockShard& the shard for the block's address
+*
+*@param p a large block
+*
+**/
+static BlockShard& shardOf(void* p){
+    //large blocks are at least 4 KB aligned, so the low bits say nothing
+    return shards[((uintptr_t)p >> 12) % BLOCK_SHARDS];
+}
+
+/**
+* hugeAllocate  method that allocates a block, on huge pages when it is large
+*
+*@return void* the block, throws bad_alloc if there is no memory or the block would take
+*the thread past its MemoryCap
+*
+*@param bytes size of the block
+*
+**/
+void* hugeAllocate(size_t bytes){
+    if(cap != 0 && allocated + bytes > cap){
+        throw bad_alloc();
+    }
+    if(bytes < HUGE_PAGE_MIN){
+        void* p = ::operator new(bytes);
+        allocated += bytes;
+        return p;
+    }
+    HugePagePolicy current = hugePagePolicy();
+    size_t length = 0;
+    void* p = NULL;
+    if(current == HUGE_PAGES_OFF){
+        p = ::operator new(bytes);
+    }
+    else{
+        //a 1 GB page is only worth it for a block that fills one
+        if(current == HUGE_PAGES_1GB && bytes >= PAGE_1GB){
+            length = roundUp(bytes, PAGE_1GB);
+            p = mapPages(length, MAP_HUGETLB | MAP_HUGE_1GB);
+        }
+        if(p == NULL && current <= HUGE_PAGES_2MB){
+            length = roundUp(bytes, PAGE_2MB);
+            p = mapPages(length, MAP_HUGETLB | MAP_HUGE_2MB);
+        }
+        if(p == NULL){
+            //ordinary pages the kernel may still back with transparent huge pages
+            length = roundUp(bytes, PAGE_2MB);
+            p = mapPages(length, MAP_NORESERVE);
+            if(p == NULL){
+                throw bad_alloc();
+            }
+            madvise(p, length, MADV_HUGEPAGE);
+        }
+    }
+    try{
+        BlockShard& shard = shardOf(p);
+        lock_guard<mutex> lock(shard.guard);
+        shard.lengths[p] = length;
+    }
+    catch(const bad_alloc&){
+        if(length == 0){
+            ::operator delete(p);
+        }
+        else{
+            munmap(p, length);
+        }
+        throw;
+    }
+    allocated += bytes;
+    return p;
+}
+
+/**
+* hugeDeallocate  method that frees a block from hugeAllocate
+*
+*@return void
+*
+*@param p the block
+*
+*@param bytes the size it was allocated with
+*
+**/
+void hugeDeallocate(void* p, size_t bytes){
+    if(p == NULL){
+        return;
+    }
+    //a block freed by another thread than its own leaves the count low, never high
+    allocated = allocated > bytes ? allocated - bytes : 0;
+    if(bytes < HUGE_PAGE_MIN){
+        ::operator delete(p);
+        return;
+    }
+    size_t length = 0;
+    {
+        BlockShard& shard = shardOf(p);
+        lock_guard<mutex> lock(shard.guard);
+        unordered_map<void*, size_t>::iterator it = shard.lengths.find(p);
+        length = it->second;
+        shard.lengths.erase(it);
+    }
+    if(length == 0){
+        ::operator delete(p);
+        return;
+    }
+    munmap(p, length);
+}
+
+/**
+* MemoryCap constructor
+*
+*@param bytes most the thread may allocate on top of what it already holds, 0 to keep the
+*cap already in force
+*
+*@post later allocations on this thread throw bad_alloc rather than pass the tighter of
+*this cap and the enclosing one
+*
+**/
+MemoryCap::MemoryCap(size_t bytes){
+    previous = cap;
+    if(bytes != 0 && (cap == 0 || allocated + bytes < cap)){
+        cap = allocated + bytes;
+    }
+}
+
+/**
+* MemoryCap destructor that puts back the cap that was in force before
+**/
+MemoryCap::~MemoryCap(){
+    cap = previous;
+}
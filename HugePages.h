@@ -0,0 +1,79 @@
+/** @file HugePages.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif huge page backed storage for the solver's large tables
+@details Big visited tables and frontiers are probed at random, so most probes miss the
+TLB when they sit on 4 KB pages. Allocations of at least HUGE_PAGE_MIN bytes are mapped
+directly with mmap, asking for 1 GB or 2 MB huge pages from the reserved pool or for
+transparent huge pages, and falling back to ordinary pages when none are available.
+The mappings are untouched until used, so on multi socket hosts each page lands on the
+NUMA node of the worker that owns the solver and first writes it. First touch is the
+whole NUMA policy: no table in this tree is shared between threads, so none is split
+across nodes by hash prefix, and there is no libnuma dependency. Every block is counted
+against the thread that allocated it, which is what lets a MemoryCap bound a solver.
+**/
+
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#include<cstddef>
+
+//what kind of pages large allocations ask for; each falls back to the ones after it
+enum HugePagePolicy{ HUGE_PAGES_1GB, HUGE_PAGES_2MB, HUGE_PAGES_TRANSPARENT, HUGE_PAGES_OFF };
+
+//smaller allocations come from the ordinary heap
+const size_t HUGE_PAGE_MIN = 1 << 21;
+
+void setHugePagePolicy(HugePagePolicy policy);
+HugePagePolicy hugePagePolicy();
+void* hugeAllocate(size_t bytes);
+void hugeDeallocate(void* p, size_t bytes);
+
+/**
+* MemoryCap caps the bytes the calling thread allocates through hugeAllocate while it is
+* in scope, net of what it frees; blocks held before it was made do not count. An
+* allocation that would pass the cap throws bad_alloc instead of reaching the kernel.
+* Caps nest, the tighter one applying until the inner one goes out of scope.
+**/
+class MemoryCap{
+public:
+    MemoryCap(size_t bytes);
+    ~MemoryCap();
+
+private:
+    MemoryCap(const MemoryCap&);
+    MemoryCap& operator=(const MemoryCap&);
+
+    size_t previous;
+};
+
+/**
+* HugePageAllocator standard allocator that hands large blocks to hugeAllocate
+**/
+template<class T>
+class HugePageAllocator{
+public:
+    typedef T value_type;
+
+    HugePageAllocator(){}
+    template<class U> HugePageAllocator(const HugePageAllocator<U>&){}
+
+    T* allocate(size_t n){
+        return (T*)hugeAllocate(n * sizeof(T));
+    }
+    void deallocate(T* p, size_t n){
+        hugeDeallocate(p, n * sizeof(T));
+    }
+};
+
+template<class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&){
+    return true;
+}
+
+template<class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&){
+    return false;
+}
+
+#endif
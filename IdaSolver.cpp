@@ -0,0 +1,456 @@
+/** @file IdaSolver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif informed low memory rush hour solver
+@details Runs deepen with a rising bound. The transposition table stores the estimate a
+board was reached with; an iteration that keeps every board and leaves none cut off has
+searched everything reachable, which proves the puzzle unsolvable.
+**/
+
+
+#include<climits>
+#include "IdaSolver.h"
+
+using namespace std;
+
+const int ESTIMATE_BITS = 10;
+const int MAX_ESTIMATE = (1 << ESTIMATE_BITS) - 1;
+
+/**
+* IdaSolver constructor
+*
+*@pre none
+*
+*@post a solver with no pattern databases
+*
+**/
+IdaSolver::IdaSolver(){
+    numCars = 0;
+    tableBits = IDA_TABLE_BITS;
+    maxTableBits = IDA_MAX_TABLE_BITS;
+    lost = 0;
+    nodes = 0;
+    nodeLimit = 0;
+    exhausted = false;
+    cancel = NULL;
+    stopped = false;
+    fillArray(board);
+}
+
+/**
+* addPatternDatabase  method that lets later solves use a database
+*
+*@return void
+*
+*@param database an open database that outlives the solver
+*
+**/
+void IdaSolver::addPatternDatabase(const PatternDatabase* database){
+    databases.push_back(database);
+}
+
+/**
+* nodesExpanded  method that reports the boards the last solve expanded
+*
+*@return uint64_t boards expanded over every iteration
+*
+**/
+uint64_t IdaSolver::nodesExpanded() const{
+    return nodes;
+}
+
+/**
+* setCancel  method that lets another thread stop later searches
+*
+*@return void
+*
+*@param cancel flag checked at every node, NULL to never stop early
+*
+**/
+void IdaSolver::setCancel(const atomic<bool>* cancel){
+    this->cancel = cancel;
+}
+
+/**
+* cancelled  method that tells a cancelled solve apart from a proof of unsolvability
+*
+*@return bool whether the last solve stopped because it was cancelled
+*
+**/
+bool IdaSolver::cancelled() const{
+    return stopped;
+}
+
+/**
+* gaveUp  method that tells a solve that ran out of nodes apart from a proof of unsolvability
+*
+*@return bool whether the last solve reached the node limit set with the memory limit
+*
+**/
+bool IdaSolver::gaveUp() const{
+    return exhausted;
+}
+
+/**
+* estimate  method that combines the blocker count with every pattern database that fits
+*
+*@return int admissible estimate of the moves left, INT_MAX if a pattern cannot be solved
+*
+**/
+int IdaSolver::estimate() const{
+    int best = blockers(cars, board);
+    for(size_t d = 0; d < active.size(); d++){
+        int distance = active[d]->lookup(cars, &bindings[d][0]);
+        if(distance == PATTERN_UNREACHABLE){
+            return INT_MAX;
+        }
+        if(distance > best){
+            best = distance;
+        }
+    }
+    return best;
+}
+
+/**
+* place  method that sets the scratch vehicles and board to a board's key
+*
+*@return void
+*
+*@param key the packed state to place
+*
+**/
+void IdaSolver::place(StateKey key){
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        int offset = (int)((key >> (KEY_BITS * i)) & ((1 << KEY_BITS) - 1));
+        if(isHorizontal(cars[i])){
+            cars[i].column = offset;
+        }
+        else{
+            cars[i].row = offset;
+        }
+        setBoard(board, cars[i], i + 1);
+    }
+}
+
+/**
+* sweep  method that runs a level by level BFS inside the transposition table, each entry
+* holding a board and its level, as long as the reachable boards fit in 3/4 of it
+*
+*@return bool whether every reachable board fit, so the answer is settled
+*
+*@param start the key of the scratch board
+*
+*@param solvable set to whether a goal was reached
+*
+*@param moves set to the minimum number of moves when one was
+*
+*@pre scratch vehicles and board hold the state of start
+*
+*@post the scratch vehicles and board are back at start
+*
+**/
+bool IdaSolver::sweep(StateKey start, bool& solvable, int& moves){
+    int bits = maxTableBits < IDA_SWEEP_BITS ? maxTableBits : IDA_SWEEP_BITS;
+    if(table.size() != (size_t)1 << bits){
+        vector<uint64_t, HugePageAllocator<uint64_t> >().swap(table);
+    }
+    table.assign((size_t)1 << bits, 0);
+    size_t mask = table.size() - 1;
+    size_t room = table.size() - table.size() / 4;
+    size_t count = 1;
+    table[(size_t)((start * 0x9E3779B97F4A7C15ULL) >> (64 - bits))] = (start + 1) << ESTIMATE_BITS;
+    solvable = isComplete(cars[0], board);
+    moves = 0;
+    bool settled = solvable;
+    for(int level = 0; !settled && level < MAX_ESTIMATE; level++){
+        settled = true;
+        for(size_t s = 0; s < table.size() && !solvable && count <= room; s++){
+            if(table[s] == 0 || (int)(table[s] & MAX_ESTIMATE) != level){
+                continue;
+            }
+            settled = false;
+            StateKey key = (table[s] >> ESTIMATE_BITS) - 1;
+            place(key);
+            nodes++;
+            for(int i = 0; i < numCars && !solvable && count <= room; i++){
+                for(int direction = 0; direction < 2 && !solvable && count <= room; direction++){
+                    StateKey step = StateKey(1) << (KEY_BITS * i);
+                    StateKey child = direction == 0 ? key + step : key - step;
+                    if(!(direction == 0 ? moveForward(cars[i], board) : moveBackward(cars[i], board))){
+                        continue;
+                    }
+                    //linear probing keeps every board, so nothing is lost below the load limit
+                    uint64_t tag = child + 1;
+                    size_t slot = (size_t)((child * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+                    while(table[slot] != 0 && (table[slot] >> ESTIMATE_BITS) != tag){
+                        slot = (slot + 1) & mask;
+                    }
+                    if(table[slot] == 0){
+                        table[slot] = (tag << ESTIMATE_BITS) | (uint64_t)(level + 1);
+                        count++;
+                        if(i == 0 && isComplete(cars[0], board)){
+                            solvable = true;
+                            moves = level + 1;
+                        }
+                    }
+                    if(direction == 0){
+                        moveBackward(cars[i], board);
+                    }
+                    else{
+                        moveForward(cars[i], board);
+                    }
+                }
+            }
+        }
+        if(solvable){
+            settled = true;
+        }
+        else if(count > room){
+            break;
+        }
+    }
+    place(start);
+    return settled;
+}
+
+/**
+* visit  method that checks a board against the transposition table and records it.
+* A bucket keeps the shallowest entries: a new board replaces an empty or the deepest entry.
+* A full bucket spills into the next one, so a table much bigger than the boards it holds
+* loses none of them.
+*
+*@return VisitResult VISIT_SEEN if the board was already reached with an equal or smaller estimate
+*
+*@param key the board's key
+*
+*@param estimate moves used plus the estimate of the moves left
+*
+**/
+VisitResult IdaSolver::visit(StateKey key, const int estimate){
+    uint64_t tag = key + 1;
+    uint64_t entry = (tag << ESTIMATE_BITS) | (uint64_t)(estimate < MAX_ESTIMATE ? estimate : MAX_ESTIMATE);
+    size_t mask = table.size() - 1;
+    size_t first = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - tableBits)) & ~(size_t)(IDA_BUCKET - 1);
+    size_t victim = first;
+    //entries are never removed within an iteration, so a board is only ever in a later
+    //bucket when every one before it is full
+    bool full = true;
+    for(int probe = 0; probe < IDA_PROBES && full; probe++){
+        size_t start = (first + probe * IDA_BUCKET) & mask;
+        for(size_t slot = start; slot < start + IDA_BUCKET; slot++){
+            uint64_t current = table[slot];
+            full = full && current != 0;
+            if((current >> ESTIMATE_BITS) == tag){
+                if((int)(current & MAX_ESTIMATE) <= estimate){
+                    return VISIT_SEEN;
+                }
+                table[slot] = entry;
+                return VISIT_STORED;
+            }
+            //empty slots look deepest of all, so they are taken first
+            if(current == 0 || (table[victim] != 0 && (current & MAX_ESTIMATE) > (table[victim] & MAX_ESTIMATE))){
+                victim = slot;
+            }
+        }
+    }
+    if(table[victim] == 0){
+        table[victim] = entry;
+        return VISIT_STORED;
+    }
+    if((int)(table[victim] & MAX_ESTIMATE) > estimate){
+        table[victim] = entry;
+    }
+    return VISIT_LOST;
+}
+
+/**
+* unresolved  method that looks for a board that was cut off by the bound and never reached
+* again within it
+*
+*@return bool whether some entry is over bound
+*
+*@param bound the iteration's bound
+*
+**/
+bool IdaSolver::unresolved(const int bound) const{
+    for(size_t i = 0; i < table.size(); i++){
+        if(table[i] != 0 && (int)(table[i] & MAX_ESTIMATE) > bound){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+*deepen  method that searches in place for a solution within bound moves, never undoing
+*the previous move straight away
+*
+*@return bool indicating a solution was found
+*
+*@param numMoves the number of moves currently used
+*
+*@param key the packed state of the scratch board
+*
+*@param bound the largest estimate searched in this iteration
+*
+*@param lastMove the previous move as 2 * car for forward and 2 * car + 1 for backward, -1 at the root
+*
+*@param nextBound lowered to the smallest estimate that went over bound
+*
+*@param moves set to the solution's length when one is found
+*
+*@pre scratch vehicles and board hold the state of key
+*
+*@post scratch vehicles and board are as they were before the call
+*
+**/
+bool IdaSolver::deepen(int numMoves, StateKey key, const int bound, const int lastMove, int& nextBound, int& moves){
+    if(stopped || (cancel != NULL && cancel->load(memory_order_relaxed))){
+        stopped = true;
+        return false;
+    }
+    if(exhausted || (nodeLimit != 0 && nodes >= nodeLimit)){
+        exhausted = true;
+        return false;
+    }
+    int left = estimate();
+    if(left == INT_MAX){
+        return false;
+    }
+    int total = numMoves + left;
+    VisitResult result = visit(key, total);
+    if(result == VISIT_SEEN){
+        return false;
+    }
+    if(result == VISIT_LOST){
+        lost++;
+    }
+    if(total > bound){
+        if(total < nextBound){
+            nextBound = total;
+        }
+        return false;
+    }
+    if(isComplete(cars[0], board)){
+        moves = numMoves;
+        return true;
+    }
+    nodes++;
+    for(int i = 0; i < numCars; i++){
+        StateKey step = StateKey(1) << (KEY_BITS * i);
+        if(lastMove != 2 * i + 1 && moveForward(cars[i], board)){
+            bool found = deepen(numMoves + 1, key + step, bound, 2 * i, nextBound, moves);
+            moveBackward(cars[i], board);
+            if(found){
+                return true;
+            }
+        }
+        if(lastMove != 2 * i && moveBackward(cars[i], board)){
+            bool found = deepen(numMoves + 1, key - step, bound, 2 * i + 1, nextBound, moves);
+            moveForward(cars[i], board);
+            if(found){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+* setMemoryLimit  method that keeps the transposition table within a number of bytes
+*
+*@return void
+*
+*@param bytes most the table may take, 0 for the usual IDA_MAX_TABLE_BITS
+*
+*@post a limit also caps the boards a solve expands at IDA_NODES_PER_ENTRY per entry
+*
+**/
+void IdaSolver::setMemoryLimit(size_t bytes){
+    maxTableBits = IDA_MAX_TABLE_BITS;
+    while(bytes != 0 && maxTableBits > IDA_MIN_TABLE_BITS && (sizeof(uint64_t) << maxTableBits) > bytes){
+        maxTableBits--;
+    }
+    if(tableBits > maxTableBits){
+        tableBits = maxTableBits;
+    }
+    nodeLimit = bytes == 0 ? 0 : IDA_NODES_PER_ENTRY << maxTableBits;
+}
+
+/**
+*solve  method that runs deepen with a rising bound until it finds a solution or proves
+*there is none
+*
+*@return bool indicating whether or not the puzzle is solvable; false proves nothing when
+*cancelled or gaveUp says so
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@pre vehicles that do not overlap
+*
+*@post nodesExpanded reports the work done
+*
+**/
+bool IdaSolver::solve(const Vehicle cars[], const int numCars, int& moves){
+    this->numCars = numCars;
+    fillArray(board);
+    StateKey key = 0;
+    for(int i = 0; i < numCars; i++){
+        this->cars[i] = cars[i];
+        setBoard(board, cars[i], i + 1);
+        key |= (StateKey)(isHorizontal(cars[i]) ? cars[i].column : cars[i].row) << (KEY_BITS * i);
+    }
+    active.clear();
+    bindings.clear();
+    for(size_t d = 0; d < databases.size(); d++){
+        vector<int> index(MAX_VEHICLE);
+        if(databases[d]->bind(cars, numCars, &index[0])){
+            active.push_back(databases[d]);
+            bindings.push_back(index);
+        }
+    }
+    nodes = 0;
+    stopped = false;
+    exhausted = false;
+    if(isProvenUnsolvable(cars, numCars)){
+        return false;
+    }
+    bool solvable = false;
+    if(sweep(key, solvable, moves)){
+        return solvable;
+    }
+
+    int bound = estimate();
+    while(bound != INT_MAX){
+        int nextBound = INT_MAX;
+        lost = 0;
+        //a table of a new size replaces the old one rather than being built beside it, so
+        //the two never have to fit under the memory limit together
+        if(table.size() != (size_t)1 << tableBits){
+            vector<uint64_t, HugePageAllocator<uint64_t> >().swap(table);
+        }
+        table.assign((size_t)1 << tableBits, 0);
+        if(deepen(0, key, bound, -1, nextBound, moves)){
+            return true;
+        }
+        if(stopped || exhausted){
+            return false;
+        }
+        //every board cut off was later reached within the bound, so all reachable boards
+        //were searched (only trusted while the table kept every board)
+        if(lost == 0 && !unresolved(bound)){
+            return false;
+        }
+        //a bigger table keeps more boards, so the proof has a chance next time
+        if(lost > 0 && tableBits < maxTableBits){
+            tableBits++;
+        }
+        bound = nextBound;
+    }
+    return false;
+}
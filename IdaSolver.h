@@ -0,0 +1,84 @@
+/** @file IdaSolver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif informed low memory rush hour solver
+@details IDA* over the in place moveForward/moveBackward recursion. The estimate is the
+larger of the blocker count and every pattern database that fits the scenario, and a fixed
+size transposition table keeps revisits in check, so memory does not grow with the search.
+A scenario with few enough reachable boards is settled by a breadth first sweep in that
+table first, since deepening can only prove there is no solution when the table keeps every
+board.
+**/
+
+#ifndef IDA_SOLVER_H
+#define IDA_SOLVER_H
+
+#include<vector>
+#include<atomic>
+#include<stdint.h>
+#include "Solver.h"
+#include "PatternDatabase.h"
+
+//the table starts at 2^IDA_TABLE_BITS entries of 8 bytes (2 MB) and doubles after an
+//iteration that lost boards, up to 2^IDA_MAX_TABLE_BITS (128 MB); a memory limit can
+//shrink it down to 2^IDA_MIN_TABLE_BITS (8 KB)
+const int IDA_TABLE_BITS = 18;
+const int IDA_MAX_TABLE_BITS = 24;
+const int IDA_MIN_TABLE_BITS = 10;
+const int IDA_BUCKET = 4;
+const int IDA_PROBES = 2;       //buckets a board may be kept in
+//under a memory limit a solve expands at most IDA_NODES_PER_ENTRY boards per table entry
+//(16M at 1 MB), since a table too small to keep every board may never prove there is no
+//solution
+const uint64_t IDA_NODES_PER_ENTRY = 128;
+//before deepening, a breadth first sweep in a table of at most 2^IDA_SWEEP_BITS entries
+//settles any scenario whose reachable boards fill no more than 3/4 of it
+const int IDA_SWEEP_BITS = 18;
+
+//what the transposition table did with a board: already reached no deeper, recorded, or
+//not kept because a shallower entry won the slot or the board pushed another one out
+enum VisitResult{ VISIT_SEEN, VISIT_STORED, VISIT_LOST };
+
+/**
+* IdaSolver reusable IDA* solver. Pattern databases are added once and used by every
+* scenario they fit.
+**/
+class IdaSolver{
+public:
+    IdaSolver();
+    void addPatternDatabase(const PatternDatabase* database);
+    bool solve(const Vehicle cars[], const int numCars, int& moves);
+    uint64_t nodesExpanded() const;
+    void setCancel(const std::atomic<bool>* cancel);
+    bool cancelled() const;
+    bool gaveUp() const;
+    void setMemoryLimit(size_t bytes);
+
+private:
+    int estimate() const;
+    void place(StateKey key);
+    bool sweep(StateKey start, bool& solvable, int& moves);
+    bool deepen(int numMoves, StateKey key, const int bound, const int lastMove, int& nextBound, int& moves);
+    VisitResult visit(StateKey key, const int estimate);
+    bool unresolved(const int bound) const;
+
+    Vehicle cars[MAX_VEHICLE];
+    int board[MAX_ARR][MAX_ARR];
+    int numCars;
+
+    std::vector<const PatternDatabase*> databases;   //every database added
+    std::vector<const PatternDatabase*> active;      //databases that fit this scenario
+    std::vector<std::vector<int> > bindings;         //scenario vehicle of each pattern vehicle
+
+    std::vector<uint64_t, HugePageAllocator<uint64_t> > table;
+    int tableBits;
+    int maxTableBits;                 //largest table the memory limit allows
+    int lost;
+    uint64_t nodes;
+    uint64_t nodeLimit;               //boards a solve may expand, 0 for no limit
+    bool exhausted;                   //the last solve reached nodeLimit before it finished
+    const std::atomic<bool>* cancel;  //set by another thread to stop the search, may be NULL
+    bool stopped;                     //the last solve was cancelled before it finished
+};
+
+#endif
@@ -0,0 +1,346 @@
+/** @file IncrementalSolver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour solver for chains of small puzzle edits
+@details Base vehicles are matched to the new scenario's vehicles by shape and lane; a
+move that is legal with the extra vehicles present is legal without them, so the new
+scenario's states always project onto states the base reached.
+**/
+
+
+#include<queue>
+#include<algorithm>
+#include<unordered_map>
+#include "IncrementalSolver.h"
+#include "StateGraph.h"
+
+using namespace std;
+
+/**
+* laneOffset  method that returns how far a vehicle is along its lane
+*
+*@return int the column of a horizontal vehicle, the row of a vertical one
+*
+**/
+static int laneOffset(const Vehicle& v){
+    return isHorizontal(v) ? v.column : v.row;
+}
+
+/**
+* sameTrack  method that checks two vehicles have the same shape and slide in the same lane
+*
+*@return bool whether one could stand in for the other
+*
+**/
+static bool sameTrack(const Vehicle& a, const Vehicle& b){
+    return a.length == b.length && a.orientation == b.orientation &&
+           (isHorizontal(a) ? a.row == b.row : a.column == b.column);
+}
+
+/**
+* keyOf  method that packs a scenario's vehicle offsets
+*
+*@return StateKey the packed state
+*
+**/
+static StateKey keyOf(const Vehicle cars[], const int numCars){
+    StateKey key = 0;
+    for(int i = 0; i < numCars; i++){
+        key |= (StateKey)laneOffset(cars[i]) << (KEY_BITS * i);
+    }
+    return key;
+}
+
+/**
+* IncrementalSolver constructor
+*
+*@pre none
+*
+*@post a solver with no base, so the first scenario becomes the base
+*
+**/
+IncrementalSolver::IncrementalSolver(){
+    baseCars = 0;
+    built = false;
+    spent = 0;
+    nextTry = 0;
+    path = INCREMENTAL_REBUILT;
+}
+
+/**
+* lastPath  method that reports how the last scenario was answered
+*
+*@return IncrementalPath lookup, guided search or a new base
+*
+**/
+IncrementalPath IncrementalSolver::lastPath() const{
+    return path;
+}
+
+/**
+* baseStates  method that reports how many states the base holds
+*
+*@return size_t states reachable from the base scenario, 0 until they are enumerated
+*
+**/
+size_t IncrementalSolver::baseStates() const{
+    return built ? keys.size() : 0;
+}
+
+/**
+* rebuild  method that makes a scenario the base and solves it by BFS
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@post the scenario is the base; its states are enumerated once the searches built on it
+*have cost as much
+*
+**/
+bool IncrementalSolver::rebuild(const Vehicle cars[], const int numCars, int& moves){
+    path = INCREMENTAL_REBUILT;
+    baseCars = numCars;
+    for(int i = 0; i < numCars; i++){
+        base[i] = cars[i];
+    }
+    built = false;
+    spent = 0;
+    bool solvable = search(cars, numCars, moves);
+    //the base reaches at least every state its own search visited
+    nextTry = ENUMERATE_COST * spent;
+    return solvable;
+}
+
+/**
+* search  method that solves a scenario by BFS and counts the work toward enumerating the base
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+**/
+bool IncrementalSolver::search(const Vehicle cars[], const int numCars, int& moves){
+    bool solvable = bfs.solve(cars, numCars, moves);
+    spent += bfs.statesVisited();
+    return solvable;
+}
+
+/**
+* bind  method that finds the scenario vehicle standing in for each base vehicle. Identical
+* vehicles sharing a lane can never pass each other, so they are matched in lane order.
+*
+*@return bool whether car 0 matches and every base vehicle has a stand in
+*
+*@param cars the new scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param index set to the scenario vehicle of each base vehicle
+*
+**/
+bool IncrementalSolver::bind(const Vehicle cars[], const int numCars, int index[]) const{
+    if(baseCars == 0 || numCars < baseCars || !sameTrack(base[0], cars[0])){
+        return false;
+    }
+    int order[MAX_VEHICLE];
+    for(int j = 0; j < baseCars; j++){
+        order[j] = j;
+    }
+    //car 0 stays first, the rest go in lane order so identical vehicles pair up in order
+    sort(order + 1, order + baseCars, [this](int a, int b){
+        return laneOffset(base[a]) < laneOffset(base[b]);
+    });
+    bool used[MAX_VEHICLE] = {false};
+    index[0] = 0;
+    used[0] = true;
+    for(int k = 1; k < baseCars; k++){
+        int j = order[k];
+        int found = -1;
+        for(int i = 1; i < numCars; i++){
+            if(!used[i] && sameTrack(base[j], cars[i]) &&
+               (found < 0 || laneOffset(cars[i]) < laneOffset(cars[found]))){
+                found = i;
+            }
+        }
+        if(found < 0){
+            return false;
+        }
+        used[found] = true;
+        index[j] = found;
+    }
+    return true;
+}
+
+/**
+* project  method that drops the vehicles the base does not have from a state
+*
+*@return StateKey the matching state of the base scenario
+*
+*@param key a packed state of the new scenario
+*
+*@param index the binding found by bind
+*
+**/
+StateKey IncrementalSolver::project(StateKey key, const int index[]) const{
+    StateKey projected = 0;
+    for(int j = 0; j < baseCars; j++){
+        projected |= ((key >> (KEY_BITS * index[j])) & 7) << (KEY_BITS * j);
+    }
+    return projected;
+}
+
+/**
+* baseDistance  method that looks up a base state's distance to the goal
+*
+*@return int the distance, GRAPH_UNSOLVABLE if the goal cannot be reached, -1 if the base
+*never reached the state
+*
+*@param key a packed state of the base scenario
+*
+**/
+int IncrementalSolver::baseDistance(StateKey key) const{
+    vector<StateKey>::const_iterator found = lower_bound(keys.begin(), keys.end(), key);
+    if(found == keys.end() || *found != key){
+        return -1;
+    }
+    return distances[found - keys.begin()];
+}
+
+/**
+* guided  method that runs A* on a scenario that adds vehicles to the base, estimating
+* each state by the larger of its blockers and its base distance
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars the new scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param index the binding found by bind
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+**/
+bool IncrementalSolver::guided(const Vehicle cars[], const int numCars, const int index[], int& moves){
+    typedef pair<int, pair<int, StateKey> > Entry;     //moves used plus estimate, moves used, state
+    priority_queue<Entry, vector<Entry>, greater<Entry> > open;
+    unordered_map<StateKey, int> reached;   //fewest moves each state was reached with
+    Vehicle scratch[MAX_VEHICLE];
+    int board[MAX_ARR][MAX_ARR];
+    for(int i = 0; i < numCars; i++){
+        scratch[i] = cars[i];
+    }
+
+    StateKey start = keyOf(cars, numCars);
+    reached[start] = 0;
+    open.push(make_pair(baseDistance(project(start, index)), make_pair(0, start)));
+    while(!open.empty()){
+        Entry top = open.top();
+        open.pop();
+        StateKey key = top.second.second;
+        int used = top.second.first;
+        //a stale entry for a state since reached in fewer moves
+        if(used > reached[key]){
+            continue;
+        }
+        fillArray(board);
+        for(int i = 0; i < numCars; i++){
+            int offset = (int)((key >> (KEY_BITS * i)) & 7);
+            if(isHorizontal(scratch[i])){
+                scratch[i].column = offset;
+            }
+            else{
+                scratch[i].row = offset;
+            }
+            setBoard(board, scratch[i], i + 1);
+        }
+        if(isComplete(scratch[0], board)){
+            moves = used;
+            return true;
+        }
+        for(int i = 0; i < numCars; i++){
+            StateKey step = StateKey(1) << (KEY_BITS * i);
+            for(int direction = 0; direction < 2; direction++){
+                bool moved = direction == 0 ? moveForward(scratch[i], board) : moveBackward(scratch[i], board);
+                if(!moved){
+                    continue;
+                }
+                StateKey child = direction == 0 ? key + step : key - step;
+                int distance = baseDistance(project(child, index));
+                unordered_map<StateKey, int>::iterator seen = reached.find(child);
+                if(distance != GRAPH_UNSOLVABLE && (seen == reached.end() || seen->second > used + 1)){
+                    reached[child] = used + 1;
+                    open.push(make_pair(used + 1 + max(blockers(scratch, board), distance), make_pair(used + 1, child)));
+                }
+                if(direction == 0){
+                    moveBackward(scratch[i], board);
+                }
+                else{
+                    moveForward(scratch[i], board);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+*solve  method that answers a scenario, reusing the base where the edit allows
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@pre vehicles that do not overlap
+*
+*@post lastPath tells how the answer was found
+*
+**/
+bool IncrementalSolver::solve(const Vehicle cars[], const int numCars, int& moves){
+    path = INCREMENTAL_LOOKUP;
+    if(isProvenUnsolvable(cars, numCars)){
+        return false;
+    }
+    int index[MAX_VEHICLE];
+    //a scenario with a vehicle removed lands here too: see IncrementalSolver.h for why
+    //the base cannot answer it
+    if(!bind(cars, numCars, index)){
+        return rebuild(cars, numCars, moves);
+    }
+    //the enumeration gets as many states as the searches so far have paid for
+    if(!built && spent >= nextTry){
+        built = reachableDistances(base, baseCars, keys, distances, spent / ENUMERATE_COST);
+        nextTry = 2 * spent;
+    }
+    if(!built){
+        path = INCREMENTAL_REBUILT;
+        return search(cars, numCars, moves);
+    }
+    int distance = baseDistance(project(keyOf(cars, numCars), index));
+    if(distance >= 0 && numCars == baseCars){
+        if(distance == GRAPH_UNSOLVABLE){
+            return false;
+        }
+        moves = distance;
+        return true;
+    }
+    if(distance >= 0){
+        path = INCREMENTAL_GUIDED;
+        //more obstacles never make an unsolvable base solvable
+        return distance != GRAPH_UNSOLVABLE && guided(cars, numCars, index, moves);
+    }
+    return rebuild(cars, numCars, moves);
+}
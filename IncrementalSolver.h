@@ -0,0 +1,69 @@
+/** @file IncrementalSolver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour solver for chains of small puzzle edits
+@details Keeps every state reachable from a base scenario with its exact distance to the
+goal, and answers later scenarios from it where it can:
+  - the same vehicles, some of them nudged to a position the base can reach: the distance
+    is looked up directly;
+  - the base with vehicles added: dropping the new vehicles only removes obstacles, so a
+    state's base distance is an admissible, consistent estimate and an A* search guided by
+    it expands little more than the solution path;
+  - anything else (a vehicle removed or moved off its lane, or nudged somewhere the base
+    cannot reach): the scenario is solved by BFS and becomes the new base.
+Enumerating a base costs several BFS solves, so scenarios built on it are solved by BFS
+too until those searches have visited ENUMERATE_COST times as many states as the base is
+known to reach; the enumeration then gets that many states. One that runs over is given
+up and tried again once the searches have cost twice as much, so a base too large to pay
+off costs at most about twice the plain BFS answers.
+Scenarios the unsolvability check settles never touch the base.
+
+Removing a vehicle is not answered incrementally. The old distances are only upper
+bounds once an obstacle is gone, and the blocker count is the only lower bound at hand,
+so proving the new answer still takes a full search; seeding a BFS with the upper bound
+would only save its last level. What a chain does gain is that the smaller scenario
+becomes the base, so putting the vehicle back is answered by the guided search.
+**/
+
+#ifndef INCREMENTAL_SOLVER_H
+#define INCREMENTAL_SOLVER_H
+
+#include<vector>
+#include "Solver.h"
+
+//enumerating a state costs about as much as this many BFS visits (1.5 us against 0.3 us)
+const uint64_t ENUMERATE_COST = 5;
+
+//how the last scenario was answered
+enum IncrementalPath{ INCREMENTAL_LOOKUP, INCREMENTAL_GUIDED, INCREMENTAL_REBUILT };
+
+/**
+* IncrementalSolver reusable solver that carries its search from one scenario to the next
+**/
+class IncrementalSolver{
+public:
+    IncrementalSolver();
+    bool solve(const Vehicle cars[], const int numCars, int& moves);
+    IncrementalPath lastPath() const;
+    size_t baseStates() const;
+
+private:
+    bool rebuild(const Vehicle cars[], const int numCars, int& moves);
+    bool search(const Vehicle cars[], const int numCars, int& moves);
+    bool bind(const Vehicle cars[], const int numCars, int index[]) const;
+    StateKey project(StateKey key, const int index[]) const;
+    int baseDistance(StateKey key) const;
+    bool guided(const Vehicle cars[], const int numCars, const int index[], int& moves);
+
+    Vehicle base[MAX_VEHICLE];          //the base scenario as read
+    int baseCars;                       //0 before the first scenario
+    bool built;                         //keys and distances describe the base
+    uint64_t spent;                     //states BFS visited answering the base's scenarios
+    uint64_t nextTry;                   //spent at which enumerating the base is tried
+    std::vector<StateKey> keys;         //states reachable from the base, sorted
+    std::vector<uint16_t> distances;    //distance of each state, GRAPH_UNSOLVABLE if none
+    IncrementalPath path;
+    Solver bfs;                         //answers scenarios that start a new base
+};
+
+#endif
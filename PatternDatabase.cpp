@@ -0,0 +1,396 @@
+/** @file PatternDatabase.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif pattern databases that give informed solvers an admissible heuristic
+@details Picks pattern vehicles, builds the distance table with a backward BFS over the
+pattern's mixed radix state range and maps finished tables back in read only.
+**/
+
+
+#include<iostream>
+#include<fstream>
+#include<vector>
+#include<algorithm>
+#include<cstring>
+#include<unistd.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "PatternDatabase.h"
+
+using namespace std;
+
+//largest pattern state range buildPatternDatabase will allocate (256 MB)
+const uint64_t PATTERN_MAX_STATES = 1ULL << 28;
+
+/**
+* offsetOf  method that returns how far a vehicle is along its lane
+*
+*@return int the column of a horizontal vehicle, the row of a vertical one
+*
+*@param v a vehicle
+*
+**/
+static int offsetOf(const Vehicle& v){
+    return isHorizontal(v) ? v.column : v.row;
+}
+
+/**
+* laneOf  method that returns the lane a vehicle slides in
+*
+*@return int the row of a horizontal vehicle, the column of a vertical one
+*
+*@param v a vehicle
+*
+**/
+static int laneOf(const Vehicle& v){
+    return isHorizontal(v) ? v.row : v.column;
+}
+
+/**
+* PatternDatabase constructor
+*
+*@pre none
+*
+*@post a database with nothing mapped
+*
+**/
+PatternDatabase::PatternDatabase(){
+    mapping = NULL;
+    mappingSize = 0;
+    header = NULL;
+    table = NULL;
+}
+
+/**
+* PatternDatabase destructor that unmaps the file
+**/
+PatternDatabase::~PatternDatabase(){
+    close();
+}
+
+/**
+* open  method that maps a pattern database file read only
+*
+*@return bool indicating the file is a well formed pattern database
+*
+*@param path the file written by buildPatternDatabase
+*
+*@pre none
+*
+*@post the table is mapped and shared with every other process mapping the file
+*
+**/
+bool PatternDatabase::open(const string& path){
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(PatternHeader)){
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED){
+        return false;
+    }
+    mapping = p;
+    mappingSize = info.st_size;
+    header = (const PatternHeader*)p;
+    if(memcmp(header->magic, PATTERN_MAGIC, sizeof(PATTERN_MAGIC)) != 0 ||
+       header->numVehicles < 1 || header->numVehicles > (uint32_t)MAX_VEHICLE ||
+       mappingSize != sizeof(PatternHeader) + header->numStates){
+        close();
+        return false;
+    }
+    table = (const uint8_t*)p + sizeof(PatternHeader);
+    uint64_t numStates = 1;
+    for(uint32_t j = 0; j < header->numVehicles; j++){
+        //bind matches scenario vehicles on these fields and lookup trusts the offsets they
+        //allow, so a vehicle no scenario can have means the header is not to be trusted
+        const PatternVehicle& v = header->vehicles[j];
+        if((v.length != CAR && v.length != TRUCK) || (v.orientation != HORIZONTAL && v.orientation != 'V') ||
+           v.lane >= MAX_ARR){
+            close();
+            return false;
+        }
+        weight[j] = numStates;
+        numStates *= MAX_ARR - header->vehicles[j].length + 1;
+    }
+    if(numStates != header->numStates){
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+* close  method that unmaps the file
+*
+*@return void
+*
+*@post nothing is mapped
+*
+**/
+void PatternDatabase::close(){
+    if(mapping != NULL){
+        munmap(mapping, mappingSize);
+    }
+    mapping = NULL;
+    mappingSize = 0;
+    header = NULL;
+    table = NULL;
+}
+
+/**
+* size  method that returns the number of vehicles in the pattern
+*
+*@return int pattern vehicles including car 0, 0 if nothing is mapped
+*
+**/
+int PatternDatabase::size() const{
+    return header == NULL ? 0 : (int)header->numVehicles;
+}
+
+/**
+* bind  method that finds the scenario vehicle playing each pattern vehicle. Identical
+* vehicles sharing a lane can never pass each other, so they are matched in lane order.
+*
+*@return bool whether the scenario contains car 0 and every other pattern vehicle
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param index set to the scenario vehicle of each pattern vehicle
+*
+**/
+bool PatternDatabase::bind(const Vehicle cars[], const int numCars, int index[]) const{
+    if(header == NULL){
+        return false;
+    }
+    bool used[MAX_VEHICLE] = {false};
+    for(uint32_t j = 0; j < header->numVehicles; j++){
+        const PatternVehicle& p = header->vehicles[j];
+        int found = -1;
+        for(int i = (j == 0 ? 0 : 1); i < (j == 0 ? 1 : numCars); i++){
+            if(!used[i] && cars[i].length == p.length && cars[i].orientation == p.orientation &&
+               laneOf(cars[i]) == p.lane && (found < 0 || offsetOf(cars[i]) < offsetOf(cars[found]))){
+                found = i;
+            }
+        }
+        if(found < 0){
+            return false;
+        }
+        used[found] = true;
+        index[j] = found;
+    }
+    return true;
+}
+
+/**
+* lookup  method that returns the pattern distance of a board
+*
+*@return int moves the pattern needs, PATTERN_UNREACHABLE if it can never be solved
+*
+*@param cars the scenario's vehicles in their current positions
+*
+*@param index the binding found by bind
+*
+**/
+int PatternDatabase::lookup(const Vehicle cars[], const int index[]) const{
+    uint64_t rank = 0;
+    for(uint32_t j = 0; j < header->numVehicles; j++){
+        rank += offsetOf(cars[index[j]]) * weight[j];
+    }
+    return table[rank];
+}
+
+/**
+* pickPattern  method that picks car 0 and the vehicles most likely to hold it up: first
+* the ones in its path, then the ones in the lanes of vehicles already picked
+*
+*@return int number of vehicles picked, car 0 included
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param size the most vehicles to pick besides car 0
+*
+*@param pattern set to the indices of the vehicles picked, car 0 first
+*
+**/
+int pickPattern(const Vehicle cars[], const int numCars, const int size, int pattern[]){
+    int board[MAX_ARR][MAX_ARR];
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        setBoard(board, cars[i], i + 1);
+    }
+    bool picked[MAX_VEHICLE] = {false};
+    int count = 1;
+    pattern[0] = 0;
+    picked[0] = true;
+    for(int k = 0; k < count && count < size + 1; k++){
+        const Vehicle& v = cars[pattern[k]];
+        //car 0 only cares about the squares ahead of it, the others about their whole lane
+        int first = k == 0 ? offsetOf(v) + v.length : 0;
+        for(int step = first; step < MAX_ARR && count < size + 1; step++){
+            int cell = isHorizontal(v) ? board[v.row][step] : board[step][v.column];
+            if(cell != 0 && !picked[cell - 1]){
+                picked[cell - 1] = true;
+                pattern[count++] = cell - 1;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+* samePatternLane  ordering that groups pattern vehicles by lane and then by offset
+*
+*@return bool whether a goes before b
+*
+**/
+static bool samePatternLane(const Vehicle& a, const Vehicle& b){
+    if(a.orientation != b.orientation){
+        return a.orientation < b.orientation;
+    }
+    if(laneOf(a) != laneOf(b)){
+        return laneOf(a) < laneOf(b);
+    }
+    return offsetOf(a) < offsetOf(b);
+}
+
+/**
+* decodePattern  method that places pattern vehicles at the offsets of a rank
+*
+*@return bool false if two vehicles overlap
+*
+*@param rank a pattern state's rank
+*
+*@param vehicles pattern vehicles, moved to the state's offsets
+*
+*@param numVehicles number of pattern vehicles
+*
+*@param board filled with the pattern vehicles
+*
+**/
+static bool decodePattern(uint64_t rank, Vehicle vehicles[], const int numVehicles, int board[][MAX_ARR]){
+    fillArray(board);
+    for(int j = 0; j < numVehicles; j++){
+        Vehicle& v = vehicles[j];
+        uint64_t radix = MAX_ARR - v.length + 1;
+        int offset = (int)(rank % radix);
+        rank /= radix;
+        if(isHorizontal(v)){
+            v.column = offset;
+        }
+        else{
+            v.row = offset;
+        }
+        for(int c = 0; c < v.length; c++){
+            if((isHorizontal(v) ? board[v.row][v.column + c] : board[v.row + c][v.column]) != 0){
+                return false;
+            }
+        }
+        setBoard(board, v, j + 1);
+    }
+    return true;
+}
+
+/**
+* buildPatternDatabase  method that computes the exact distance of every pattern state by a
+* backward BFS from the goal states and writes the table to a file
+*
+*@return bool indicating the file was written
+*
+*@param cars the scenario's vehicles
+*
+*@param pattern indices of the pattern vehicles, car 0 first
+*
+*@param patternSize number of pattern vehicles
+*
+*@param path file to write
+*
+*@pre pattern[0] is 0
+*
+*@post a file open can map
+*
+**/
+bool buildPatternDatabase(const Vehicle cars[], const int pattern[], const int patternSize, const string& path){
+    if(patternSize < 1 || patternSize > MAX_VEHICLE || pattern[0] != 0){
+        return false;
+    }
+    Vehicle vehicles[MAX_VEHICLE];
+    for(int j = 0; j < patternSize; j++){
+        vehicles[j] = cars[pattern[j]];
+    }
+    sort(vehicles + 1, vehicles + patternSize, samePatternLane);
+
+    PatternHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PATTERN_MAGIC, sizeof(PATTERN_MAGIC));
+    header.numVehicles = patternSize;
+    uint64_t weight[MAX_VEHICLE];
+    uint64_t numStates = 1;
+    for(int j = 0; j < patternSize; j++){
+        header.vehicles[j].length = vehicles[j].length;
+        header.vehicles[j].orientation = vehicles[j].orientation;
+        header.vehicles[j].lane = laneOf(vehicles[j]);
+        weight[j] = numStates;
+        numStates *= MAX_ARR - vehicles[j].length + 1;
+    }
+    header.numStates = numStates;
+    if(numStates > PATTERN_MAX_STATES){
+        cerr << "pattern has " << numStates << " states, more than " << PATTERN_MAX_STATES << endl;
+        return false;
+    }
+
+    //every legal state with car 0 at the exit is a goal; moves are reversible, so a BFS
+    //out of the goals gives each state's distance to the nearest goal
+    vector<uint8_t> distance(numStates, PATTERN_UNREACHABLE);
+    vector<uint32_t> level;
+    vector<uint32_t> next;
+    int board[MAX_ARR][MAX_ARR];
+    for(uint64_t rank = 0; rank < numStates; rank++){
+        if(decodePattern(rank, vehicles, patternSize, board) && isComplete(vehicles[0], board)){
+            distance[rank] = 0;
+            level.push_back((uint32_t)rank);
+        }
+    }
+    for(int depth = 1; !level.empty(); depth++){
+        //a byte saturates below PATTERN_UNREACHABLE, which only weakens the bound
+        uint8_t stored = depth < PATTERN_UNREACHABLE ? depth : PATTERN_UNREACHABLE - 1;
+        for(size_t f = 0; f < level.size(); f++){
+            uint64_t rank = level[f];
+            decodePattern(rank, vehicles, patternSize, board);
+            for(int j = 0; j < patternSize; j++){
+                if(moveForward(vehicles[j], board)){
+                    if(distance[rank + weight[j]] == PATTERN_UNREACHABLE){
+                        distance[rank + weight[j]] = stored;
+                        next.push_back((uint32_t)(rank + weight[j]));
+                    }
+                    moveBackward(vehicles[j], board);
+                }
+                if(moveBackward(vehicles[j], board)){
+                    if(distance[rank - weight[j]] == PATTERN_UNREACHABLE){
+                        distance[rank - weight[j]] = stored;
+                        next.push_back((uint32_t)(rank - weight[j]));
+                    }
+                    moveForward(vehicles[j], board);
+                }
+            }
+        }
+        level.swap(next);
+        next.clear();
+    }
+
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)&distance[0], distance.size());
+    return (bool)out;
+}
@@ -0,0 +1,70 @@
+/** @file PatternDatabase.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif pattern databases that give informed solvers an admissible heuristic
+@details A pattern keeps car 0 and a few chosen vehicles and drops the rest. Dropping
+vehicles only removes obstacles, so the exact distance to the goal in the pattern is a
+lower bound on the real distance. The distances of every pattern state are found once
+by a backward BFS from the goal states with the usual move rules and written to a file
+that is memory mapped read only, so any number of processes share one copy.
+
+File layout: a PatternHeader followed by one byte per pattern state, indexed by the
+state's mixed radix rank (PATTERN_UNREACHABLE where the goal cannot be reached).
+**/
+
+#ifndef PATTERN_DATABASE_H
+#define PATTERN_DATABASE_H
+
+#include<string>
+#include<cstddef>
+#include<stdint.h>
+#include "Solver.h"
+
+const char PATTERN_MAGIC[8] = {'R', 'H', 'P', 'D', 'B', '1', 0, 0};
+const uint8_t PATTERN_UNREACHABLE = 255;
+//vehicles kept besides car 0 when the pattern is picked automatically
+const int PATTERN_DEFAULT_SIZE = 7;
+
+struct PatternVehicle{
+    uint8_t length;
+    char orientation;
+    uint8_t lane;       //the row of a horizontal vehicle, the column of a vertical one
+    uint8_t unused;
+};
+
+struct PatternHeader{
+    char magic[8];
+    uint32_t numVehicles;
+    uint32_t unused;
+    PatternVehicle vehicles[MAX_VEHICLE];
+    uint64_t numStates;
+};
+
+/**
+* PatternDatabase read only view of a memory mapped pattern database file
+**/
+class PatternDatabase{
+public:
+    PatternDatabase();
+    ~PatternDatabase();
+    bool open(const std::string& path);
+    void close();
+    bool bind(const Vehicle cars[], const int numCars, int index[]) const;
+    int lookup(const Vehicle cars[], const int index[]) const;
+    int size() const;
+
+private:
+    PatternDatabase(const PatternDatabase&);
+    PatternDatabase& operator=(const PatternDatabase&);
+
+    void* mapping;
+    size_t mappingSize;
+    const PatternHeader* header;
+    const uint8_t* table;
+    uint64_t weight[MAX_VEHICLE];
+};
+
+int pickPattern(const Vehicle cars[], const int numCars, const int size, int pattern[]);
+bool buildPatternDatabase(const Vehicle cars[], const int pattern[], const int patternSize, const std::string& path);
+
+#endif
@@ -0,0 +1,133 @@
+/** @file Portfolio.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif races several rush hour engines on one scenario
+@details The engines are started on fresh threads for every scenario and joined before
+solve returns, so the solvers are never used by two scenarios at once.
+**/
+
+
+#include<thread>
+#include<chrono>
+#include "Portfolio.h"
+
+using namespace std;
+
+/**
+* engineName  method that names an engine for logs
+*
+*@return const char* the engine's name
+*
+*@param engine an engine
+*
+**/
+const char* engineName(PortfolioEngine engine){
+    switch(engine){
+        case ENGINE_BFS:
+            return "bfs";
+        case ENGINE_BIDIRECTIONAL:
+            return "bidirectional";
+        case ENGINE_IDA:
+            return "ida";
+        default:
+            return "none";
+    }
+}
+
+/**
+* Portfolio constructor
+*
+*@pre none
+*
+*@post engines that stop when the portfolio's flag is set
+*
+**/
+Portfolio::Portfolio(){
+    cancel = false;
+    bfs.setCancel(&cancel);
+    bidirectional.setCancel(&cancel);
+    ida.setCancel(&cancel);
+}
+
+/**
+* addPatternDatabase  method that lets the IDA* engine use a database
+*
+*@return void
+*
+*@param database an open database that outlives the portfolio
+*
+**/
+void Portfolio::addPatternDatabase(const PatternDatabase* database){
+    ida.addPatternDatabase(database);
+}
+
+/**
+* finish  method that records an engine's proven answer if it is the first and stops the others
+*
+*@return void
+*
+*@param engine the engine that finished
+*
+*@param status exact or unsolvable
+*
+*@param moves the answer when exact
+*
+**/
+void Portfolio::finish(PortfolioEngine engine, SolveStatus status, int moves){
+    lock_guard<mutex> guard(lock);
+    if(result.winner == ENGINE_NONE){
+        result.winner = engine;
+        result.status = status;
+        result.moves = moves;
+        cancel = true;
+    }
+}
+
+/**
+*solve  method that races every engine on a scenario
+*
+*@return PortfolioResult the first proven answer and the engine that found it
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@pre vehicles that do not overlap
+*
+*@post every engine has stopped
+*
+**/
+PortfolioResult Portfolio::solve(const Vehicle cars[], const int numCars){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cancel = false;
+    result.status = SOLVE_BOUNDED;
+    result.moves = -1;
+    result.winner = ENGINE_NONE;
+
+    thread bfsThread([&](){
+        SolveResult answer = bfs.solveBounded(cars, numCars);
+        if(answer.status != SOLVE_BOUNDED){
+            finish(ENGINE_BFS, answer.status, answer.lower);
+        }
+    });
+    thread bidirectionalThread([&](){
+        int moves = -1;
+        SolveStatus status = bidirectional.solve(cars, numCars, moves);
+        if(status != SOLVE_BOUNDED){
+            finish(ENGINE_BIDIRECTIONAL, status, moves);
+        }
+    });
+    thread idaThread([&](){
+        int moves = -1;
+        bool solved = ida.solve(cars, numCars, moves);
+        if(!ida.cancelled()){
+            finish(ENGINE_IDA, solved ? SOLVE_EXACT : SOLVE_UNSOLVABLE, moves);
+        }
+    });
+    bfsThread.join();
+    bidirectionalThread.join();
+    idaThread.join();
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,55 @@
+/** @file Portfolio.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif races several rush hour engines on one scenario
+@details Every engine proves its answer, so whichever finishes first is right. The BFS,
+the bidirectional BFS and IDA* each run on their own thread; the first to prove the answer
+or that there is none sets a shared flag the others poll, and the result records which
+engine won so engine choice can be learned per kind of puzzle.
+**/
+
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include<atomic>
+#include<mutex>
+#include "Solver.h"
+#include "IdaSolver.h"
+#include "BidirectionalSolver.h"
+#include "PatternDatabase.h"
+
+enum PortfolioEngine{ ENGINE_NONE, ENGINE_BFS, ENGINE_BIDIRECTIONAL, ENGINE_IDA };
+
+struct PortfolioResult{
+    SolveStatus status;         //exact or unsolvable once an engine won
+    int moves;                  //set when exact
+    PortfolioEngine winner;
+    double seconds;             //wall clock time until every engine stopped
+};
+
+const char* engineName(PortfolioEngine engine);
+
+/**
+* Portfolio reusable engine race. Each engine keeps its buffers warm between scenarios.
+**/
+class Portfolio{
+public:
+    Portfolio();
+    void addPatternDatabase(const PatternDatabase* database);
+    PortfolioResult solve(const Vehicle cars[], const int numCars);
+
+private:
+    Portfolio(const Portfolio&);
+    Portfolio& operator=(const Portfolio&);
+
+    void finish(PortfolioEngine engine, SolveStatus status, int moves);
+
+    Solver bfs;
+    BidirectionalSolver bidirectional;
+    IdaSolver ida;
+    std::atomic<bool> cancel;
+    std::mutex lock;                //guards result while engines finish
+    PortfolioResult result;
+};
+
+#endif
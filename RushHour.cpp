@@ -2,633 +2,625 @@
  @author Aaron Mcanerney, Justin Gill, Dylan Simard
 @version Revision 1.0
 @breif solves the rush hour game using BFS
-@details Uses BFS to solve the rush hour puzzle game. Uses structs,maps, and queues to
-output a solution to rushour in an efficient time.
+@details Uses BFS to solve the rush hour puzzle game. Reads every scenario from stdin and
+hands it to one reusable Solver (see Solver.h) so each puzzle is solved with warm buffers.
 @date 12/6/2017
 **/
 
 
 #include<iostream>
-#include<map>
-#include<set>
-#include<queue>
 #include<fstream>
 #include<string>
+#include<cstdlib>
+#include<vector>
+#include<chrono>
+#include "Solver.h"
+#include "Server.h"
+#include "PatternDatabase.h"
+#include "IdaSolver.h"
+#include "StateGraph.h"
+#include "Portfolio.h"
+#include "IncrementalSolver.h"
+#include "Verifier.h"
+#include "DistributedSolver.h"
+#include "SortedSolver.h"
 
 using namespace std;
 
-struct Vehicle{
-    int length;
-    char orientation;
-    int row;
-    int column;
-};
+void read(const int numCars, Vehicle cars[]);
+bool readFirst(Vehicle cars[], int& numCars);
+int buildPattern(const string& path, const string& list);
+int exportGraph(const string& path);
+int checkGraph(const string& path);
+int benchProbe(VisitedBackend backend);
+void usage();
 
-struct Board{
-
-    Board(int numCars){
-        cars = new Vehicle[numCars];
-        numMoves = 0;
-        fillBoard();
-        generateID();
-    }
-
-    ~Board(){
-        delete [] cars;
-    }
-    Vehicle* cars;
-    void fillBoard(){
-        for(int i = 0; i < 36; i++){
-            state[i / 6][i % 6] = 0;
+/**
+* Main method
+*
+*@return int indicating success
+*
+*@param argc number of command line arguments
+*
+*@param argv command line arguments, see usage
+*
+*@pre unsolved rush hour
+*
+*@post solved rush hour
+*
+*
+**/
+int main(int argc, char* argv[]){
+    string socketPath;
+    int workers = 0;
+    VisitedBackend backend = VISITED_AUTO;
+    bool informed = false;
+    bool racing = false;
+    bool sorting = false;
+    bool incremental = false;
+    int processes = 0;
+    string logPath;
+    double seconds = 0;
+    uint64_t nodes = 0;
+    size_t memoryLimit = 0;
+    int maxMoves = -1;
+    size_t probeBatch = PROBE_BATCH;
+    bool bench = false;
+    bool verifying = false;
+    bool verifyOptimal = false;
+    string checkpointPath;
+    double checkpointSeconds = CHECKPOINT_SECONDS;
+    string resumePath;
+    string buildPath;
+    string graphPath;
+    string checkPath;
+    string patternList;
+    vector<string> patternPaths;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--serve" && i + 1 < argc){
+            socketPath = argv[++i];
+        }
+        else if(arg == "--workers" && i + 1 < argc){
+            workers = atoi(argv[++i]);
+        }
+        else if(arg == "--visited" && i + 1 < argc){
+            string name = argv[++i];
+            if(name == "hash"){
+                backend = VISITED_HASH;
+            }
+            else if(name == "dense"){
+                backend = VISITED_DENSE;
+            }
+            else if(name != "auto"){
+                usage();
+                return 1;
+            }
         }
-    }
-
-    Board& operator=(const Board& other){
-        if(this != &other){
-            id = "";
-            int numMoves = other.numMoves;
-            cars = new Vehicle[18];
-            for(int i = 0; i < 36; i++){
-                state[i / 6][i % 6] = other.state[i / 6][i % 6];
+        else if(arg == "--huge-pages" && i + 1 < argc){
+            string name = argv[++i];
+            if(name == "1gb"){
+                setHugePagePolicy(HUGE_PAGES_1GB);
+            }
+            else if(name == "2mb"){
+                setHugePagePolicy(HUGE_PAGES_2MB);
+            }
+            else if(name == "thp"){
+                setHugePagePolicy(HUGE_PAGES_TRANSPARENT);
+            }
+            else if(name == "off"){
+                setHugePagePolicy(HUGE_PAGES_OFF);
+            }
+            else{
+                usage();
+                return 1;
             }
-            generateID();
         }
-        return *this;
-    }
-
-    void stringToBoard(const string s){
-        for(int i =0; i< 36; i++){
-            id[i] = state[i / 6][i % 6];
+        else if(arg == "--engine" && i + 1 < argc){
+            string name = argv[++i];
+            if(name == "ida"){
+                informed = true;
+            }
+            else if(name == "portfolio"){
+                racing = true;
+            }
+            else if(name == "sorted"){
+                sorting = true;
+            }
+            else if(name != "bfs"){
+                usage();
+                return 1;
+            }
+        }
+        else if(arg == "--incremental"){
+            incremental = true;
+        }
+        else if(arg == "--distributed" && i + 1 < argc){
+            processes = atoi(argv[++i]);
+            if(processes < 1){
+                usage();
+                return 1;
+            }
+        }
+        else if(arg == "--portfolio-log" && i + 1 < argc){
+            logPath = argv[++i];
+        }
+        else if(arg == "--time-limit" && i + 1 < argc){
+            seconds = atof(argv[++i]);
+        }
+        else if(arg == "--node-limit" && i + 1 < argc){
+            nodes = strtoull(argv[++i], NULL, 10);
+        }
+        else if(arg == "--memory-limit" && i + 1 < argc){
+            memoryLimit = (size_t)strtoull(argv[++i], NULL, 10) << 20;
+        }
+        else if(arg == "--max-moves" && i + 1 < argc){
+            maxMoves = atoi(argv[++i]);
+            if(maxMoves < 0){
+                usage();
+                return 1;
+            }
+        }
+        else if(arg == "--probe-batch" && i + 1 < argc){
+            probeBatch = strtoul(argv[++i], NULL, 10);
+        }
+        else if(arg == "--bench-probe"){
+            bench = true;
+        }
+        else if(arg == "--verify"){
+            verifying = true;
+        }
+        else if(arg == "--verify-optimal"){
+            verifying = true;
+            verifyOptimal = true;
+        }
+        else if(arg == "--checkpoint" && i + 1 < argc){
+            checkpointPath = argv[++i];
+        }
+        else if(arg == "--checkpoint-every" && i + 1 < argc){
+            checkpointSeconds = atof(argv[++i]);
+        }
+        else if(arg == "--resume" && i + 1 < argc){
+            resumePath = argv[++i];
+        }
+        else if(arg == "--pdb" && i + 1 < argc){
+            patternPaths.push_back(argv[++i]);
+        }
+        else if(arg == "--build-pdb" && i + 1 < argc){
+            buildPath = argv[++i];
+        }
+        else if(arg == "--export-graph" && i + 1 < argc){
+            graphPath = argv[++i];
+        }
+        else if(arg == "--graph-check" && i + 1 < argc){
+            checkPath = argv[++i];
+        }
+        else if(arg == "--pattern" && i + 1 < argc){
+            patternList = argv[++i];
+        }
+        else{
+            usage();
+            return 1;
         }
     }
-
-    Board(const Board& other){
-        id ="";
-        cars = new Vehicle[18];
-        numMoves = other.numMoves;
-        for(int i =0; i< 18; i++){
-            cars[i] = other.cars[i];
-        }
-        fillBoard();
-        for(int i = 0; i < 36; i++){
-            state[i / 6][i % 6] = other.state[i / 6][i % 6];
-        }
-        generateID();
+    if(!socketPath.empty()){
+        return serve(socketPath, workers);
     }
-
-    int state[6][6];
-
-    string id;
-    int numMoves;
-    int numCars;
-
-    void incMoves(){
-        numMoves++;
+    if(!buildPath.empty()){
+        return buildPattern(buildPath, patternList);
     }
-    void generateID(){
-        for(int i = 0; i < 36; i++){
-            id.push_back(state[i / 6][i % 6] + '0');
-        }
+    if(!graphPath.empty()){
+        return exportGraph(graphPath);
     }
-
-    string getID(){
-        return id;
+    if(!checkPath.empty()){
+        return checkGraph(checkPath);
     }
-    void printID(){
-        for(int i = 0; i < 36; i++){
-            cout << id[i];
-        }
+    if(bench){
+        return benchProbe(backend);
+    }
+    if(verifying){
+        return verifyStream(stdin, workers, verifyOptimal);
     }
-};
 
+    //budgets, checkpoints and the memory limit are only honoured by the engines that take
+    //them, so a run that would silently ignore one is refused
+    const char* mode = processes > 0 ? "--distributed" : incremental ? "--incremental" :
+                       racing ? "--engine portfolio" : informed ? "--engine ida" : sorting ? "--engine sorted" : NULL;
+    const char* ignored = seconds > 0 ? "--time-limit" : nodes > 0 ? "--node-limit" :
+                          !checkpointPath.empty() ? "--checkpoint" : !resumePath.empty() ? "--resume" :
+                          memoryLimit != 0 && (processes > 0 || incremental || racing) ? "--memory-limit" : NULL;
+    if(mode != NULL && ignored != NULL){
+        cerr << ignored << " cannot be used with " << mode << endl;
+        return 1;
+    }
 
-//consts for array size, car and truck size, and horizontal check
-const int CAR = 2;
-const int TRUCK = 3;
-const char HORIZONTAL = 'H';
-const int MAX_VEHICLE = 18;
-const int MAX_ARR = 6;
-void read(int board[][MAX_ARR], int& numCars, Vehicle* cars);
-void setBoard(int board[][MAX_ARR], const Vehicle& v, const int car);
-bool isCar(const Vehicle& v);
-void print(const int board[][MAX_ARR]);
-void fillArray(int board[][MAX_ARR]);
-bool moveForward(Vehicle& v, Board& board);
-bool moveBackward(Vehicle& v, Board& board);
-bool isComplete(const Vehicle& v, const int board[][MAX_ARR]);
-bool isHorizontal(const Vehicle& v);
-void solve(int& numMoves, Vehicle* cars, Board& board, int& best,const int& numCars, bool& result);
-bool isCollisionForward(const Vehicle& v, const int board[][MAX_ARR]);
-bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]);
+    //the databases stay mapped for the whole run
+    vector<PatternDatabase*> databases;
+    IdaSolver ida;
+    Portfolio portfolio;
+    IncrementalSolver chain;
+    DistributedSolver cluster;
+    SortedSolver sorted;
+    if(processes > 0 && !cluster.start(processes)){
+        cerr << "cannot start " << processes << " solver processes" << endl;
+        return 1;
+    }
+    for(size_t i = 0; i < patternPaths.size(); i++){
+        PatternDatabase* database = new PatternDatabase();
+        if(!database->open(patternPaths[i])){
+            cerr << "cannot open pattern database " << patternPaths[i] << endl;
+            return 1;
+        }
+        databases.push_back(database);
+        ida.addPatternDatabase(database);
+        portfolio.addPatternDatabase(database);
+    }
+    //one line per scenario naming the engine that won the race
+    ofstream log;
+    if(!logPath.empty()){
+        log.open(logPath.c_str(), ios::app);
+    }
 
-/**
-* Main method
-*
-*@return int indicating success
-*
-*@pre unsolved rush hour
-*
-*@post solved rush hour
-*
-*
-**/
-int main(){
-    //declare variables needed for board and cars/trucks
-    Board board(MAX_VEHICLE);
+    //one solver serves every scenario so its buffers stay warm
+    Solver solver;
+    solver.setVisitedBackend(backend);
+    solver.setBudget(seconds, nodes);
+    solver.setProbeBatch(probeBatch);
+    solver.setMemoryLimit(memoryLimit);
+    ida.setMemoryLimit(memoryLimit);
+    //a resumed search keeps checkpointing to the file it came from
+    Checkpoint checkpoint;
+    if(!resumePath.empty()){
+        if(!readCheckpoint(resumePath, checkpoint)){
+            cerr << "cannot read checkpoint " << resumePath << endl;
+            return 1;
+        }
+        solver.setResume(&checkpoint);
+        if(checkpointPath.empty()){
+            checkpointPath = resumePath;
+        }
+    }
+    solver.setCheckpoint(checkpointPath, checkpointSeconds);
+    bool budgeted = !informed && !racing && !sorting && !incremental && processes == 0 && (seconds > 0 || nodes > 0);
+    Vehicle cars[MAX_VEHICLE];
     int numCars = -1;
     int counter = 1;
-    while(numCars!=0)
+    //a scenario with zero vehicles ends the input
+    while(cin >> numCars && numCars != 0)
     {
-        //fill the array board with ambiguous numbers to start (flag of 0 indicating no car or truck)
-        fillArray(board.state);
-        //read in the board from stdin
-        cin >> numCars;
-        read(board.state, numCars, board.cars);
-        //set up game variables
+        //read in the vehicles from stdin
+        read(numCars, cars);
+        if(budgeted){
+            //settle for bounds when the budget runs out
+            SolveResult result = solver.solveBounded(cars, numCars);
+            if(maxMoves >= 0 && (result.status != SOLVE_EXACT || result.lower > maxMoves)){
+                //--max-moves only reports scenarios known to take no more moves
+            }
+            else if(result.status == SOLVE_EXACT){
+                cout << "Scenario " << counter << " requires " << result.lower << " moves"<<endl;
+            }
+            else if(result.status == SOLVE_BOUNDED && result.upper >= 0){
+                cout << "Scenario " << counter << " requires " << result.lower << " to " << result.upper << " moves"
+                     << (solver.memoryCapped() ? " (bounded, memory limit)" : " (bounded)") << endl;
+            }
+            else if(result.status == SOLVE_BOUNDED){
+                cout << "Scenario " << counter << " requires at least " << result.lower << " moves"
+                     << (solver.memoryCapped() ? " (bounded, memory limit)" : " (bounded)") << endl;
+            }
+            else{
+                cout << "Scenario " << counter << " cannot be solved"<<endl;
+            }
+            counter++;
+            continue;
+        }
+
+        if(racing){
+            PortfolioResult result = portfolio.solve(cars, numCars);
+            if(maxMoves >= 0 && (result.status != SOLVE_EXACT || result.moves > maxMoves)){
+                //--max-moves only reports scenarios known to take no more moves
+            }
+            else if(result.status == SOLVE_EXACT){
+                cout << "Scenario " << counter << " requires " << result.moves << " moves"<<endl;
+            }
+            else{
+                cout << "Scenario " << counter << " cannot be solved"<<endl;
+            }
+            if(log.is_open()){
+                log << counter << " " << numCars << " " << engineName(result.winner) << " "
+                    << result.moves << " " << result.seconds << endl;
+            }
+            counter++;
+            continue;
+        }
+
+        //solve with BFS unless another engine was asked for
         int moves = 0;
-        int best = 11;
         bool result = false;
-        //solve with BFS
-        solve(moves, board.cars,board,best, numCars, result);
+        bool fellBack = false;
+        if(processes > 0){
+            result = cluster.solve(cars, numCars, moves);
+            if(cluster.failed()){
+                //the workers are gone, so this scenario and every later one are solved here
+                cerr << "solving the remaining scenarios in this process" << endl;
+                processes = 0;
+                result = solver.solve(cars, numCars, moves);
+                fellBack = solver.memoryCapped();
+            }
+        }
+        else if(incremental){
+            result = chain.solve(cars, numCars, moves);
+        }
+        else if(informed){
+            result = ida.solve(cars, numCars, moves);
+        }
+        else if(sorting){
+            //buffers kept from the last scenario would not count against the cap
+            if(memoryLimit != 0){
+                sorted = SortedSolver();
+            }
+            try{
+                MemoryCap cap(memoryLimit);
+                result = sorted.solve(cars, numCars, moves);
+            }
+            catch(const bad_alloc&){
+                sorted = SortedSolver();
+                fellBack = true;
+            }
+        }
+        else{
+            result = solver.solve(cars, numCars, moves);
+            fellBack = solver.memoryCapped();
+        }
+        if(fellBack){
+            //the search outgrew --memory-limit, so IDA* finishes the scenario with a bounded table
+            result = ida.solve(cars, numCars, moves);
+        }
 
         //print out whether or not we found a solution
-        if(result){
-            cout << "Scenario " << counter << " requires " << best << " moves"<<endl;
+        const char* note = fellBack ? " (memory limit, IDA*)" : "";
+        bool known = result && !((informed || fellBack) && ida.gaveUp());
+        if(maxMoves >= 0 && (!known || moves > maxMoves)){
+            //--max-moves only reports scenarios known to take no more moves
+        }
+        else if((informed || fellBack) && ida.gaveUp()){
+            //IDA* ran out of the nodes its capped table allows without settling the scenario
+            cout << "Scenario " << counter << " unknown (memory limit)" << endl;
+        }
+        else if(result){
+            cout << "Scenario " << counter << " requires " << moves << " moves" << note << endl;
+        }
+        else{
+            cout << "Scenario " << counter << " cannot be solved" << note << endl;
         }
         counter++;
     }
 
+    for(size_t i = 0; i < databases.size(); i++){
+        delete databases[i];
+    }
     return 1;
 }
 
 /**
-* read  method that  populates the board and vehicles array.
-*uses helper function set board.
+* readFirst  method that reads the first scenario on stdin for the one scenario modes
 *
-*@return void
+*@return bool indicating a valid scenario was read
 *
-*@param board board that the game is played on
+*@param cars array the vehicles are read into
 *
-*@param v a vehicle
-*
-*@param numCars the number of cars on the board
-*
-*@pre unfilled board and car array
-*
-*@post filled board and car array
+*@param numCars set to the number of vehicles
 *
 **/
-
-void read(int board[][MAX_ARR], int& numCars, Vehicle cars[]){
-    for(int i = 0; i < numCars; i++){
-        Vehicle v;
-        cin >> v.length >> v.orientation >> v.row >> v.column;
-        cars[i] = v;
-        setBoard(board, v, i+1);
+bool readFirst(Vehicle cars[], int& numCars){
+    if(!(cin >> numCars) || numCars < 1 || numCars > MAX_VEHICLE){
+        cerr << "expected a scenario on stdin" << endl;
+        return false;
     }
-}
-
-
-/**
-* Set board  method that populates the two dimensional array with cars
-*
-*@return void
-*
-*@param v a vehicle
-*
-*@param board board that the game is played on
-*
-*@pre array and vehile with car number to be displayed
-*
-*@post a board with a new car in postion x,y
-*
-**/
-void setBoard(int board[][MAX_ARR], const Vehicle& v, const int car){
-    for(int i = 0 ; i < v.length; i++){
-        if(isHorizontal(v)){
-            board[v.row][v.column + i] = car;
-        }
-        else{
-            board[v.row + i][v.column] = car;
-        }
+    read(numCars, cars);
+    if(!isValidScenario(cars, numCars)){
+        cerr << "the scenario is not valid" << endl;
+        return false;
     }
+    return true;
 }
 
 /**
-* IsCar  method that indcates whether a vehicle is a car or a truck
-*
-*@return bool is a a car?
-*
-*@param v a vehicle
-*
-*@pre vehicle v
-*
-*@post whether or not they vehicle is a car
-*
-**/
-bool isCar(const Vehicle& v){
-    return v.length == CAR;
-}
-
-
-/**
-* IsHorizontal method that indcates whether a vehicle is horizontal
-*
-*@return bool is a horizontal?
+* exportGraph  method that writes the reachable state graph of the first scenario on stdin
 *
-*@param v a vehicle
+*@return int 0 if the file was written
 *
-*@pre vehicle v
-*
-*@post whether or not they vehicle is horizontal
+*@param path file to write
 *
 **/
-bool isHorizontal(const Vehicle& v){
-    return v.orientation == HORIZONTAL;
-}
-
-/**
-* print  method that prints the board
-*
-*@return void
-*
-*@param board board that the game is played on
-*
-*@pre a const board
-*
-*@post a printed 2d array
-*
-**/
-void print(const int board[][MAX_ARR]){
-    for(int i = 0; i <  6; i ++){
-        for(int j = 0; j < 6; j ++){
-            cout << board[i][j] << " ";
-        }
-        cout << endl;
+int exportGraph(const string& path){
+    Vehicle cars[MAX_VEHICLE];
+    int numCars = 0;
+    if(!readFirst(cars, numCars)){
+        return 1;
     }
-    cout << endl;
-}
-
-/**
-* fillArray  method that populates the board with 0's
-*
-*@return void
-*
-*@param board board that the game is played on
-*
-*@pre and empty board
-*
-*@post a 2d array filled with zeros
-*
-**/
-void fillArray(int board[][MAX_ARR]){
-    for(int i = 0; i <  MAX_ARR; i ++){
-        for(int j = 0; j < MAX_ARR; j ++){
-            board[i][j] = 0;
-        }
+    if(!exportStateGraph(cars, numCars, path)){
+        cerr << "cannot export state graph " << path << endl;
+        return 1;
     }
+    return 0;
 }
 
-
 /**
-* isCollissionForward  method that indcates whether or not moving a vehicle forward results in a collision
-*
-*@return bool indicating collision course
-*
-*@param board board that the game is played on
+* checkGraph  method that reads an exported state graph back and checks it against the BFS
 *
-*@param v a vehicle
+*@return int 0 if the graph matches
 *
-*@pre vehicle v, 2d board
-*
-*@post a boolean value indicating collision
+*@param path file written by --export-graph
 *
 **/
-bool isCollisionForward(const Vehicle& v, const int board[][MAX_ARR]){
-    if(isHorizontal(v)){
-        if(isCar(v)){
-            if(board[v.row][v.column + CAR] != 0){
-                return true;
-            }
-        }
-        else{
-            if(board[v.row][v.column + TRUCK] != 0){
-                return true;
-            }
-        }
+int checkGraph(const string& path){
+    uint64_t numNodes = 0;
+    uint64_t numEdges = 0;
+    if(!checkStateGraph(path, numNodes, numEdges)){
+        return 1;
     }
-    else{
-        if(isCar(v)){
-            if(board[v.row + CAR][v.column] != 0){
-                return true;
-            }
-        }
-        else{
-            if(board[v.row + TRUCK][v.column] != 0){
-                return true;
-            }
-        }
-    }
-    return false;
+    cout << path << ": " << numNodes << " nodes and " << numEdges << " edges match the BFS" << endl;
+    return 0;
 }
+
 /**
-* isCollissionBackwards  method that indcates whether or not moving a vehicle backwards results in a collision
+* benchProbe  method that solves every scenario on stdin once per probe batch size and
+* reports how fast states are discovered, so batching can be tuned for a host
 *
-*@return bool indicating collision course
+*@return int 0
 *
-*@param board board that the game is played on
-*
-*@param v a vehicle
-*
-*@pre vehicle v, 2d board
-*
-*@post a boolean value indicating collision
+*@param backend visited set to benchmark; probing only stalls once it outgrows the cache
 *
 **/
-bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]){
-    if(isHorizontal(v)){
-        if(isCar(v)){
-            if(board[v.row][v.column - 1] != 0){
-                return true;
-            }
-        }
-        else{
-            if(board[v.row][v.column - 1] != 0){
-                return true;
-            }
-        }
+int benchProbe(VisitedBackend backend){
+    vector<vector<Vehicle> > scenarios;
+    int numCars = 0;
+    while(cin >> numCars && numCars != 0){
+        vector<Vehicle> cars(numCars);
+        read(numCars, &cars[0]);
+        scenarios.push_back(cars);
     }
-    else{
-        if(isCar(v)){
-            if(board[v.row - 1][v.column] != 0){
-                return true;
-            }
-        }
-        else{
-            if(board[v.row - 1][v.column] != 0){
-                return true;
-            }
-        }
+    const size_t batches[] = {1, 8, 32, 64, 128, 256};
+    for(size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++){
+        Solver solver;
+        solver.setVisitedBackend(backend);
+        solver.setProbeBatch(batches[b]);
+        uint64_t states = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for(size_t s = 0; s < scenarios.size(); s++){
+            int moves = 0;
+            solver.solve(&scenarios[s][0], (int)scenarios[s].size(), moves);
+            states += solver.statesVisited();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "batch " << batches[b] << ": " << states << " states in " << seconds << " s, "
+             << (uint64_t)(states / seconds) << " states/s" << endl;
     }
-    return false;
+    return 0;
 }
 
 /**
-*MoveForward  method that indcates whether or not moving a vehicle forward is legal
-* and moves the car forward if so
-*
-*@return bool indicating if the vehicle was moved forward
+* buildPattern  method that builds a pattern database for the first scenario on stdin
 *
-*@param board board that the game is played on
+*@return int 0 if the file was written
 *
-*@param v a vehicle
+*@param path file to write
 *
-*@pre vehicle v, 2d board
-*
-*@post a boolean value indicating if the car was moved. A car in a new position on the board.
+*@param list comma separated vehicle indices after car 0, empty to pick them automatically
 *
 **/
-bool moveForward(Vehicle& v, Board& board){
-    int set = board.state[v.row][v.column];
-    if(isHorizontal(v)){
-        if(isCar(v)){
-            if(v.column + CAR < MAX_ARR){
-                if(!isCollisionForward(v, board.state)){
-                    board.state[v.row][v.column] = 0;
-                    v.column++;
-                    for(int i = 0; i < CAR; i++){
-                        board.state[v.row][v.column + i] = set;
-                    }
-                    return true;
-                }
-            }
-        }
-        else{
-            if(v.column + TRUCK < MAX_ARR){
-                if(!isCollisionForward(v, board.state)){
-                    board.state[v.row][v.column] = 0;
-                    v.column++;
-                    for(int i = 0; i < TRUCK; i++){
-                        board.state[v.row][v.column + i] = set;
-                    }
-                    return true;
-                }
-            }
-        }
+int buildPattern(const string& path, const string& list){
+    Vehicle cars[MAX_VEHICLE];
+    int numCars = 0;
+    if(!readFirst(cars, numCars)){
+        return 1;
+    }
+    int pattern[MAX_VEHICLE];
+    int patternSize = 0;
+    if(list.empty()){
+        patternSize = pickPattern(cars, numCars, PATTERN_DEFAULT_SIZE, pattern);
     }
     else{
-        if(isCar(v)){
-            if(v.row + CAR < MAX_ARR){
-                if(!isCollisionForward(v, board.state)){
-                    board.state[v.row][v.column] = 0;
-                    v.row++;
-                    for(int i = 0; i < CAR; i++){
-                        board.state[v.row + i][v.column] = set;
-                    }
-                    return true;
-                }
+        pattern[patternSize++] = 0;
+        size_t start = 0;
+        while(start <= list.size() && patternSize < MAX_VEHICLE){
+            size_t end = list.find(',', start);
+            if(end == string::npos){
+                end = list.size();
             }
-        }
-        else{
-            if(v.row + TRUCK < MAX_ARR){
-                if(!isCollisionForward(v, board.state)){
-                    board.state[v.row][v.column] = 0;
-                    v.row++;
-                    for(int i = 0; i < TRUCK; i++){
-                        board.state[v.row + i][v.column] = set;
-                    }
-                    return true;
-                }
+            int index = atoi(list.substr(start, end - start).c_str());
+            if(index < 1 || index >= numCars){
+                cerr << "no vehicle " << list.substr(start, end - start) << " in the scenario" << endl;
+                return 1;
             }
+            pattern[patternSize++] = index;
+            start = end + 1;
         }
     }
-    return false;
-}
-
-
-/**
-*MoveBackward  method that indcates whether or not moving a vehicle backward is legal
-* and moves the car forward if so
-*
-*@return bool indicating if the vehicle was moved backward
-*
-*@param board board that the game is played on
-*
-*@param v a vehicle
-*
-*@pre vehicle v, 2d board
-*
-*@post a boolean value indicating if the car was moved. A car in a new position on the board.
-*
-**/
-bool moveBackward(Vehicle& v, Board& board){
-    int set = board.state[v.row][v.column];
-        if(isHorizontal(v)){
-            if(isCar(v)){
-                if(v.column - 1 >= 0){
-                    if(!isCollisionBackward(v, board.state)){
-                        board.state[v.row][v.column + 1] = 0;
-                        v.column--;
-                        for(int i = 0; i < CAR; i++){
-                            board.state[v.row][v.column + i] = set;
-                        }
-                        return true;
-                    }
-                }
-            }
-            else{
-                if(v.column - 1 >= 0){
-                    if(!isCollisionBackward(v, board.state)){
-                        board.state[v.row][v.column + 2] = 0;
-                        v.column--;
-                        for(int i = 0; i < TRUCK; i++){
-                            board.state[v.row][v.column + i] = set;
-                        }
-                        return true;
-                    }
-                }
-            }
-        }
-        else{
-            if(isCar(v)){
-                if(v.row - 1 >= 0){
-                    if(!isCollisionBackward(v, board.state)){
-                        board.state[v.row + 1][v.column] = 0;
-                        v.row--;
-                        for(int i = 0; i < CAR; i++){
-                            board.state[v.row + i][v.column] = set;
-                        }
-                        return true;
-                    }
-                }
-            }
-            else{
-                if(v.row - 1 >= 0){
-                    if(!isCollisionBackward(v, board.state)){
-                        board.state[v.row + 2][v.column] = 0;
-                        v.row--;
-                        for(int i = 0; i < TRUCK; i++){
-                            board.state[v.row + i][v.column] = set;
-                        }
-                        return true;
-                    }
-                }
-            }
-        }
-        return false;
+    if(!buildPatternDatabase(cars, pattern, patternSize, path)){
+        cerr << "cannot build pattern database " << path << endl;
+        return 1;
+    }
+    return 0;
 }
 
-
 /**
-*isComplete used as base case. Determines whether or not to still play the game.
+* read  method that  populates the vehicles array.
 *
-*@return boolean Whether or not the first car is at the far right position
+*@return void
 *
-*@param board board that the game is played on
+*@param numCars the number of cars on the board
 *
-*@param v a vehicle
+*@param cars array the vehicles are read into
 *
-*@pre vehicle v, 2d board
+*@pre unfilled car array
 *
-*@post a boolean value indicating if the game is complete.
+*@post filled car array
 *
 **/
-bool isComplete(const Vehicle& v, const int board[][MAX_ARR]){
 
-    if(isHorizontal(v)){
-        if(isCar(v)){
-            if(v.column + CAR == MAX_ARR)
-                return true;
-        }
-        else{
-            if(v.column + TRUCK == MAX_ARR){
-                return true;
-            }
-        }
-        return false;
-    }
-    else{
-        if(isCar(v)){
-            if(v.row + CAR == MAX_ARR)
-                return true;
-        }
-        else{
-            if(v.row + TRUCK == MAX_ARR){
-                return true;
-            }
-        }
-        return false;
+void read(const int numCars, Vehicle cars[]){
+    for(int i = 0; i < numCars; i++){
+        Vehicle v;
+        cin >> v.length >> v.orientation >> v.row >> v.column;
+        cars[i] = v;
     }
 }
 
 /**
-*solve  method that recursivley checks every possible move and calculates the minimum possible
-*moves it requires to complete the game (if such moves exist)
+* usage  method that prints the command line options
 *
 *@return void
 *
-*@param board board that the game is played on
-*
-*@param cars an array containing every car on the board
-*
-*@param numMoves the number of moves currently used
-*
-*@param best the best score thus far
-*
-*@param result indicates whether or not the puzzle is solvable
-*
-*@param numCars number of cars currently on the board
-*
-*@pre vehicle v, 2d board
-*
-*@post a boolean value indicating if the car was moved. A car in a new position on the board.
-*
 **/
-
-void solve(int& numMoves, Vehicle cars[], Board& board, int& best, const int& numCars, bool& result){
-    queue<Board> queue;     //queue containing boards
-    map<string, int> map;    //maps an indicated state to the number of moves it takes to reach said state
-    queue.push(board);
-    map[board.getID()] = numMoves;
-
-    while(!queue.empty()){
-
-        Board parentState(queue.front());
-        queue.pop();
-        //check if is complete
-        if(isComplete(parentState.cars[0], parentState.state) || numMoves > best){
-            if(map[parentState.getID()] < best){
-                best = parentState.numMoves;
-                result = true;
-                return;
-            }
-            else{
-                return;
-            }
-        }
-        //if a piece was moved that is considered a new state
-        for(int i = 0; i < numCars; i++){
-            //move every piece and snapshot the board
-            Board forwards(parentState);
-            Board backwards(parentState);
-            if(moveForward(forwards.cars[i], forwards)){
-                forwards.generateID();
-                if(map.find(forwards.getID()) == map.end()){
-                    forwards.incMoves();
-                    map[forwards.getID()] = map[parentState.getID()] + 1;
-                    queue.push(forwards);
-                }
-            }
-            if(moveBackward(backwards.cars[i], backwards)){
-               backwards.generateID();
-                if(map.find(backwards.getID()) == map.end()){
-                    backwards.incMoves();
-                    map[backwards.getID()] = map[parentState.getID()] + 1;
-                    queue.push(backwards);
-                }
-            }
-        }
-    }
+void usage(){
+    cerr << "usage: RushHour [--visited auto|hash|dense] [--huge-pages 1gb|2mb|thp|off] [--engine bfs|ida|portfolio|sorted] [--pdb file]...\n"
+         << "                [--time-limit seconds] [--node-limit n] [--memory-limit MB] [--probe-batch n]\n"
+         << "                [--max-moves n]\n"
+         << "                [--checkpoint file [--checkpoint-every seconds]] [--resume file]\n"
+         << "                [--portfolio-log file] [--incremental] [--distributed n] [--serve socket [--workers n]]" << endl;
+    cerr << "       RushHour --build-pdb file [--pattern i,j,...] < scenario" << endl;
+    cerr << "       RushHour --export-graph file < scenario" << endl;
+    cerr << "       RushHour --graph-check file" << endl;
+    cerr << "       RushHour --verify|--verify-optimal [--workers n] < solutions" << endl;
+    cerr << "  with no --serve scenarios are read from stdin until a 0 scenario" << endl;
+    cerr << "  every scenario is reported, unsolvable ones included; the original program only" << endl;
+    cerr << "    printed solutions under 11 moves, and --max-moves n restores such a cap, reporting" << endl;
+    cerr << "    only the scenarios known to take at most n moves" << endl;
+    cerr << "  --visited picks the visited set: a hash table or a bitmap over every state" << endl;
+    cerr << "  --huge-pages picks the largest pages tried for big tables (default thp); reserved" << endl;
+    cerr << "    1gb or 2mb pages fall back to transparent huge pages, then to ordinary pages" << endl;
+    cerr << "  --probe-batch sets how many children are prefetched before the visited set is" << endl;
+    cerr << "    probed; --bench-probe times the scenarios on stdin at several batch sizes" << endl;
+    cerr << "  --incremental treats the scenarios as a chain of edits: each is answered from every" << endl;
+    cerr << "    state reachable from an earlier scenario when it only nudges or adds vehicles;" << endl;
+    cerr << "    removing a vehicle is solved from scratch and starts a new base" << endl;
+    cerr << "  --distributed n runs the BFS on n processes, each holding the states that hash to it" << endl;
+    cerr << "  --time-limit and --node-limit cap each BFS scenario; when a cap is hit the answer is" << endl;
+    cerr << "    reported as bounds: the levels searched and the length of a beam search solution" << endl;
+    cerr << "  --checkpoint saves the BFS at a level boundary at most every --checkpoint-every" << endl;
+    cerr << "    seconds (default 60); --resume continues the checkpointed scenario where it stopped," << endl;
+    cerr << "    solving the scenarios before it again, and keeps checkpointing to the same file" << endl;
+    cerr << "  --memory-limit caps the tables of a BFS or sorted scenario; one that reaches it is" << endl;
+    cerr << "    released and finished by IDA* with a table under the cap, noted after its answer," << endl;
+    cerr << "    or reported as bounds under --time-limit and --node-limit; checkpoint copies and" << endl;
+    cerr << "    pattern databases are not counted against it. IDA* under the cap expands at most" << endl;
+    cerr << "    128 boards per table entry (16M per MB) and reports the scenario as unknown" << endl;
+    cerr << "    when that runs out" << endl;
+    cerr << "  --time-limit, --node-limit, --checkpoint and --resume only apply to the bfs engine" << endl;
+    cerr << "    and --memory-limit to bfs, ida and sorted; other combinations are refused" << endl;
+    cerr << "  --engine ida solves with IDA*, using every --pdb pattern database that fits" << endl;
+    cerr << "  --engine sorted runs the BFS without a visited set, radix sorting each level's" << endl;
+    cerr << "    children and merging away the two levels before them" << endl;
+    cerr << "  --engine portfolio races BFS, bidirectional BFS and IDA* on each scenario and takes" << endl;
+    cerr << "    the first proven answer; --portfolio-log file appends the scenario, its number of" << endl;
+    cerr << "    vehicles, the winning engine, the moves (-1 if unsolvable) and the seconds taken" << endl;
+    cerr << "  --build-pdb writes a pattern database for the first scenario, keeping car 0 and" << endl;
+    cerr << "    the --pattern vehicles or, by default, the ones in its way" << endl;
+    cerr << "  --verify replays claimed solutions (a scenario, then the number of moves and one" << endl;
+    cerr << "    \"vehicle squares\" line per move) and reports each as valid or why it is not;" << endl;
+    cerr << "    --verify-optimal also requires the fewest moves" << endl;
+    cerr << "  --export-graph writes every state reachable from the first scenario, its distance" << endl;
+    cerr << "    to the goal and the moves between states as a compressed sparse row file;" << endl;
+    cerr << "    --graph-check maps such a file and checks it against a fresh BFS" << endl;
 }
-
-
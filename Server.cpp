@@ -0,0 +1,614 @@
+/** @file Server.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif long lived rush hour solver daemon
+@details The epoll thread reads and parses requests, hands them to the worker pool through
+a job queue and writes answers back in request order once the workers post them on the
+completion queue (an eventfd wakes the loop). SIGINT and SIGTERM are blocked in every
+thread and read by the loop through a signalfd, so no worker can swallow them. See
+Server.h for the wire format.
+**/
+
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<deque>
+#include<map>
+#include<unordered_map>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<cerrno>
+#include<csignal>
+#include<cstring>
+#include<cstdlib>
+#include<unistd.h>
+#include<fcntl.h>
+#include<pthread.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+#include<sys/epoll.h>
+#include<sys/eventfd.h>
+#include<sys/signalfd.h>
+#include "Solver.h"
+#include "Server.h"
+
+using namespace std;
+
+const size_t CACHE_CAPACITY = 1 << 20;
+const int MAX_EVENTS = 64;
+
+struct Job{
+    int fd;
+    uint64_t connId;
+    uint64_t seq;
+    bool binary;
+    int numCars;
+    Vehicle cars[MAX_VEHICLE];
+    bool result;
+    int moves;
+};
+
+struct Connection{
+    uint64_t id;
+    string in;
+    string out;
+    uint64_t nextSeq;                //sequence number given to the next request
+    uint64_t nextToSend;             //sequence number of the next answer to write
+    map<uint64_t, string> ready;     //answers that finished ahead of an earlier request
+    bool closing;                    //no more requests will be read
+    uint32_t events;                 //events currently watched in epoll
+};
+
+/**
+* ResultCache scenario to move count map shared by every worker. It is simply emptied
+* once it reaches its capacity.
+**/
+class ResultCache{
+public:
+    bool find(const string& key, bool& result, int& moves){
+        lock_guard<mutex> lock(guard);
+        unordered_map<string, int>::const_iterator it = table.find(key);
+        if(it == table.end()){
+            return false;
+        }
+        result = it->second >= 0;
+        moves = it->second;
+        return true;
+    }
+    void insert(const string& key, bool result, int moves){
+        lock_guard<mutex> lock(guard);
+        if(table.size() >= CACHE_CAPACITY){
+            table.clear();
+        }
+        table[key] = result ? moves : -1;
+    }
+private:
+    mutex guard;
+    unordered_map<string, int> table;
+};
+
+static mutex jobGuard;
+static condition_variable jobReady;
+static deque<Job> jobs;
+static bool workersDone = false;
+static atomic<bool> stopping(false);   //set on shutdown so solves in flight give up
+
+static mutex doneGuard;
+static vector<Job> completed;
+static int wakeFd = -1;
+
+static ResultCache cache;
+
+/**
+* scenarioKey  method that builds the cache key of a scenario
+*
+*@return string one byte per vehicle field
+*
+*@param job a parsed request
+*
+**/
+static string scenarioKey(const Job& job){
+    string key;
+    for(int i = 0; i < job.numCars; i++){
+        key.push_back((char)job.cars[i].length);
+        key.push_back(job.cars[i].orientation);
+        key.push_back((char)job.cars[i].row);
+        key.push_back((char)job.cars[i].column);
+    }
+    return key;
+}
+
+/**
+* worker  thread body that solves jobs with its own warm Solver
+*
+*@return void
+*
+*@pre a running event loop
+*
+*@post every job it takes is posted to the completion queue
+*
+**/
+static void worker(){
+    Solver solver;
+    solver.setCancel(&stopping);
+    while(true){
+        Job job;
+        {
+            unique_lock<mutex> lock(jobGuard);
+            while(jobs.empty() && !workersDone){
+                jobReady.wait(lock);
+            }
+            if(jobs.empty()){
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+        string key = scenarioKey(job);
+        if(!cache.find(key, job.result, job.moves)){
+            job.moves = 0;
+            job.result = solver.solve(job.cars, job.numCars, job.moves);
+            if(stopping.load(memory_order_relaxed)){
+                //a cancelled solve proves nothing and nobody is left to answer
+                return;
+            }
+            cache.insert(key, job.result, job.moves);
+        }
+        {
+            lock_guard<mutex> lock(doneGuard);
+            completed.push_back(job);
+        }
+        uint64_t one = 1;
+        if(write(wakeFd, &one, sizeof(one)) < 0){
+            //the counter is already non zero, so the loop will wake anyway
+        }
+    }
+}
+
+/**
+* nextToken  method that reads one whitespace separated token
+*
+*@return int 1 for a token, 0 if the buffer ends before the token is terminated
+*
+*@param in input buffer
+*
+*@param pos read position, advanced past the token
+*
+*@param token the token read
+*
+*@param eof the peer sent all it will, so the end of the buffer ends the last token
+*
+**/
+static int nextToken(const string& in, size_t& pos, string& token, bool eof){
+    while(pos < in.size() && isspace((unsigned char)in[pos])){
+        pos++;
+    }
+    size_t start = pos;
+    while(pos < in.size() && !isspace((unsigned char)in[pos])){
+        pos++;
+    }
+    if(pos == in.size() && (!eof || pos == start)){
+        return 0;
+    }
+    token = in.substr(start, pos - start);
+    return 1;
+}
+
+/**
+* parseRequest  method that parses the next request in a connection's input buffer
+*
+*@return int 1 for a complete scenario, 0 if more input is needed, 2 for the 0 scenario,
+*-1 for a malformed request
+*
+*@param in input buffer
+*
+*@param pos read position, advanced past a complete request
+*
+*@param job the parsed request
+*
+*@param eof the peer sent all it will
+*
+**/
+static int parseRequest(const string& in, size_t& pos, Job& job, bool eof){
+    size_t p = pos;
+    while(p < in.size() && isspace((unsigned char)in[p])){
+        p++;
+    }
+    if(p == in.size()){
+        return 0;
+    }
+    if((unsigned char)in[p] & BINARY_FRAME){
+        job.binary = true;
+        job.numCars = (unsigned char)in[p] & ~BINARY_FRAME;
+        if(job.numCars < 1 || job.numCars > MAX_VEHICLE){
+            return -1;
+        }
+        if(in.size() - p < 1 + 4 * (size_t)job.numCars){
+            return 0;
+        }
+        p++;
+        for(int i = 0; i < job.numCars; i++){
+            job.cars[i].length = (unsigned char)in[p++];
+            job.cars[i].orientation = in[p++];
+            job.cars[i].row = (unsigned char)in[p++];
+            job.cars[i].column = (unsigned char)in[p++];
+        }
+    }
+    else{
+        job.binary = false;
+        string token;
+        if(!nextToken(in, p, token, eof)){
+            return 0;
+        }
+        job.numCars = atoi(token.c_str());
+        if(job.numCars == 0 && token == "0"){
+            pos = p;
+            return 2;
+        }
+        if(job.numCars < 1 || job.numCars > MAX_VEHICLE){
+            return -1;
+        }
+        for(int i = 0; i < job.numCars; i++){
+            string length, orientation, row, column;
+            if(!nextToken(in, p, length, eof) || !nextToken(in, p, orientation, eof) ||
+               !nextToken(in, p, row, eof) || !nextToken(in, p, column, eof)){
+                return 0;
+            }
+            if(orientation.size() != 1){
+                return -1;
+            }
+            job.cars[i].length = atoi(length.c_str());
+            job.cars[i].orientation = orientation[0];
+            job.cars[i].row = atoi(row.c_str());
+            job.cars[i].column = atoi(column.c_str());
+        }
+    }
+    if(!isValidScenario(job.cars, job.numCars)){
+        return -1;
+    }
+    pos = p;
+    return 1;
+}
+
+/**
+* formatAnswer  method that renders a finished job in its request's framing
+*
+*@return string bytes to send
+*
+*@param job a finished job
+*
+**/
+static string formatAnswer(const Job& job){
+    if(job.binary){
+        int32_t value = job.result ? job.moves : BINARY_UNSOLVABLE;
+        string out(4, '\0');
+        for(int i = 0; i < 4; i++){
+            out[i] = (char)((uint32_t)value >> (8 * i));
+        }
+        return out;
+    }
+    string out = "Scenario " + to_string(job.seq + 1);
+    if(job.result){
+        out += " requires " + to_string(job.moves) + " moves\n";
+    }
+    else{
+        out += " cannot be solved\n";
+    }
+    return out;
+}
+
+/**
+* EventLoop  the epoll instance and every open connection. Only the loop thread touches it.
+**/
+class EventLoop{
+public:
+    EventLoop(int listenFd, int signalFd) : listenFd(listenFd), signalFd(signalFd), nextId(1), stopped(false){
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(wakeFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(signalFd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    ~EventLoop(){
+        for(map<int, Connection>::iterator it = conns.begin(); it != conns.end(); it++){
+            close(it->first);
+        }
+        close(epollFd);
+    }
+
+    void run(){
+        epoll_event events[MAX_EVENTS];
+        while(!stopped){
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if(n < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                cerr << "epoll_wait: " << strerror(errno) << endl;
+                return;
+            }
+            for(int i = 0; i < n; i++){
+                int fd = events[i].data.fd;
+                if(fd == listenFd){
+                    acceptAll();
+                }
+                else if(fd == wakeFd){
+                    drainCompleted();
+                }
+                else if(fd == signalFd){
+                    //SIGINT or SIGTERM; read so it is not delivered once they are unblocked
+                    signalfd_siginfo info;
+                    if(read(signalFd, &info, sizeof(info)) == (ssize_t)sizeof(info)){
+                        stopped = true;
+                    }
+                }
+                else if(conns.count(fd)){
+                    if(events[i].events & (EPOLLHUP | EPOLLERR)){
+                        //the peer is gone, so nothing more can be delivered
+                        drop(fd);
+                        continue;
+                    }
+                    if(events[i].events & EPOLLIN){
+                        readFrom(fd);
+                    }
+                    if(conns.count(fd) && (events[i].events & EPOLLOUT)){
+                        flush(fd);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    void watch(int fd, uint32_t events, int op){
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, op, fd, &ev);
+    }
+
+    void acceptAll(){
+        while(true){
+            int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd < 0){
+                return;
+            }
+            Connection& c = conns[fd];
+            c.id = nextId++;
+            c.nextSeq = 0;
+            c.nextToSend = 0;
+            c.closing = false;
+            c.events = EPOLLIN;
+            watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+        }
+    }
+
+    void readFrom(int fd){
+        Connection& c = conns[fd];
+        char buf[65536];
+        //a full buffer waits for the parse below; the rest stays in the socket
+        while(!c.closing && c.in.size() < MAX_INPUT){
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if(n > 0){
+                c.in.append(buf, n);
+                continue;
+            }
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                break;
+            }
+            if(n < 0 && errno == EINTR){
+                continue;
+            }
+            c.closing = true;
+        }
+        bool eof = c.closing;
+        size_t pos = 0;
+        while(!c.in.empty()){
+            Job job;
+            int status = parseRequest(c.in, pos, job, eof);
+            if(status == 0){
+                //no request needs this much, so the peer is not sending one
+                if(c.in.size() - pos >= MAX_INPUT){
+                    status = -1;
+                    job.binary = false;
+                }
+                else{
+                    break;
+                }
+            }
+            if(status == 1){
+                job.fd = fd;
+                job.connId = c.id;
+                job.seq = c.nextSeq++;
+                bool queued = false;
+                {
+                    lock_guard<mutex> lock(jobGuard);
+                    if(jobs.size() < MAX_JOBS){
+                        jobs.push_back(job);
+                        queued = true;
+                    }
+                }
+                if(queued){
+                    jobReady.notify_one();
+                    continue;
+                }
+                //the workers are too far behind; the request is refused and the
+                //connection closed like a malformed one
+                c.ready[job.seq] = job.binary ? formatError() : "error\n";
+                c.closing = true;
+                pos = c.in.size();
+                break;
+            }
+            if(status < 0){
+                c.ready[c.nextSeq++] = job.binary ? formatError() : "error\n";
+            }
+            c.closing = true;
+            pos = c.in.size();
+        }
+        c.in.erase(0, pos);
+        flush(fd);
+    }
+
+    static string formatError(){
+        string out(4, '\0');
+        for(int i = 0; i < 4; i++){
+            out[i] = (char)((uint32_t)BINARY_ERROR >> (8 * i));
+        }
+        return out;
+    }
+
+    void drainCompleted(){
+        uint64_t count;
+        if(read(wakeFd, &count, sizeof(count)) < 0){
+            //spurious wake up, the queue below is checked regardless
+        }
+        vector<Job> done;
+        {
+            lock_guard<mutex> lock(doneGuard);
+            done.swap(completed);
+        }
+        for(size_t i = 0; i < done.size(); i++){
+            map<int, Connection>::iterator it = conns.find(done[i].fd);
+            if(it == conns.end() || it->second.id != done[i].connId){
+                continue;
+            }
+            it->second.ready[done[i].seq] = formatAnswer(done[i]);
+            flush(done[i].fd);
+        }
+    }
+
+    void flush(int fd){
+        Connection& c = conns[fd];
+        while(!c.ready.empty() && c.ready.begin()->first == c.nextToSend){
+            c.out += c.ready.begin()->second;
+            c.ready.erase(c.ready.begin());
+            c.nextToSend++;
+        }
+        size_t sent = 0;
+        while(sent < c.out.size()){
+            ssize_t n = send(fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+            if(n > 0){
+                sent += n;
+                continue;
+            }
+            if(n < 0 && errno == EINTR){
+                continue;
+            }
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                break;
+            }
+            drop(fd);
+            return;
+        }
+        c.out.erase(0, sent);
+        if(c.closing && c.out.empty() && c.nextToSend == c.nextSeq){
+            drop(fd);
+            return;
+        }
+        uint32_t events = (c.closing ? 0 : (uint32_t)EPOLLIN) | (c.out.empty() ? 0 : (uint32_t)EPOLLOUT);
+        if(events != c.events){
+            c.events = events;
+            watch(fd, events, EPOLL_CTL_MOD);
+        }
+    }
+
+    void drop(int fd){
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+        close(fd);
+        conns.erase(fd);
+    }
+
+    int listenFd;
+    int signalFd;
+    int epollFd;
+    uint64_t nextId;
+    bool stopped;                    //a shutdown signal arrived
+    map<int, Connection> conns;
+};
+
+/**
+* serve  method that runs the daemon until it receives SIGINT or SIGTERM
+*
+*@return int 0 on a clean shutdown, 1 if the socket could not be set up
+*
+*@param path file system path of the Unix domain socket
+*
+*@param numWorkers number of solver threads, 0 picks one per core
+*
+*@pre no other process is serving on path
+*
+*@post the socket file is removed
+*
+**/
+int serve(const string& path, int numWorkers){
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)){
+        cerr << "socket path too long: " << path << endl;
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if(listenFd < 0 || bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+       listen(listenFd, SOMAXCONN) < 0){
+        cerr << "cannot listen on " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    //a server run earlier in this process left its queues drained and its workers told to
+    //stop; the result cache is kept, since its answers still hold
+    workersDone = false;
+    stopping = false;
+    jobs.clear();
+    completed.clear();
+
+    //blocked before the workers start so they inherit the mask and only the signalfd
+    //sees the signals
+    sigset_t stopSignals;
+    sigset_t previousMask;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &previousMask);
+    int signalFd = signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    if(numWorkers <= 0){
+        numWorkers = thread::hardware_concurrency();
+        if(numWorkers <= 0){
+            numWorkers = 1;
+        }
+    }
+    vector<thread> pool;
+    for(int i = 0; i < numWorkers; i++){
+        pool.push_back(thread(worker));
+    }
+
+    {
+        EventLoop loop(listenFd, signalFd);
+        loop.run();
+    }
+
+    stopping = true;
+    {
+        lock_guard<mutex> lock(jobGuard);
+        workersDone = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for(size_t i = 0; i < pool.size(); i++){
+        pool[i].join();
+    }
+    close(listenFd);
+    close(wakeFd);
+    close(signalFd);
+    pthread_sigmask(SIG_SETMASK, &previousMask, NULL);
+    unlink(path.c_str());
+    return 0;
+}
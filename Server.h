@@ -0,0 +1,47 @@
+/** @file Server.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif long lived rush hour solver daemon
+@details Listens on a Unix domain socket and answers scenarios with move counts. One
+epoll loop owns every connection and feeds a pool of workers that each keep a warm
+Solver; solved scenarios are shared between workers through a result cache.
+
+Requests may be pipelined and mixed on one connection:
+  text   - the stdin format ("numCars" then "length orientation row column" per vehicle),
+           answered with "Scenario N requires M moves" or "Scenario N cannot be solved".
+           A scenario with 0 vehicles asks the server to close the connection.
+  binary - one byte 0x80 | numCars followed by 4 bytes per vehicle (length, orientation,
+           row, column), answered with a little endian int32 move count or -1 if unsolvable.
+Malformed requests get "error" (text) or -2 (binary) and the connection is closed, as do
+requests that arrive while MAX_JOBS are already queued and partial requests that pass
+MAX_INPUT bytes. A text request may end at the end of the stream instead of whitespace.
+
+A cached answer comes back in tens of microseconds; a first solve takes as long as its BFS,
+a few milliseconds for the larger test puzzles, so sub-millisecond latency only holds for
+repeats and small puzzles. Shutdown cancels the solves in flight.
+**/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include<string>
+
+const int BINARY_FRAME = 0x80;
+const int BINARY_UNSOLVABLE = -1;
+const int BINARY_ERROR = -2;
+const size_t MAX_JOBS = 1 << 16;        //queued requests before new ones are refused
+const size_t MAX_INPUT = 1 << 16;       //unparsed bytes a connection may buffer
+
+/**
+* serve  method that runs the daemon until it receives SIGINT or SIGTERM
+*
+*@return int 0 on a clean shutdown, 1 if the socket could not be set up
+*
+*@param path file system path of the Unix domain socket
+*
+*@param numWorkers number of solver threads, 0 picks one per core
+*
+**/
+int serve(const std::string& path, int numWorkers);
+
+#endif
@@ -0,0 +1,1867 @@
+/** @file Solver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif solves the rush hour game using BFS
+@details Implements the move rules and the reusable Solver. States are packed into
+a 64 bit key holding each vehicle's offset in its lane, and the BFS walks the levels
+with two frontier buffers of state ranks and a visited set that are kept between scenarios. The visited set is
+an open addressing hash table, or a bitmap over every possible state when the puzzle's rank
+space is small enough.
+**/
+
+
+#include<iostream>
+#include<algorithm>
+#include<chrono>
+#include<cstring>
+#include<new>
+#include<queue>
+#include "Solver.h"
+
+using namespace std;
+
+/**
+* Set board  method that populates the two dimensional array with cars
+*
+*@return void
+*
+*@param v a vehicle
+*
+*@param board board that the game is played on
+*
+*@pre array and vehile with car number to be displayed
+*
+*@post a board with a new car in postion x,y
+*
+**/
+void setBoard(int board[][MAX_ARR], const Vehicle& v, const int car){
+    for(int i = 0 ; i < v.length; i++){
+        if(isHorizontal(v)){
+            board[v.row][v.column + i] = car;
+        }
+        else{
+            board[v.row + i][v.column] = car;
+        }
+    }
+}
+
+/**
+* IsCar  method that indcates whether a vehicle is a car or a truck
+*
+*@return bool is a a car?
+*
+*@param v a vehicle
+*
+*@pre vehicle v
+*
+*@post whether or not they vehicle is a car
+*
+**/
+bool isCar(const Vehicle& v){
+    return v.length == CAR;
+}
+
+
+/**
+* IsHorizontal method that indcates whether a vehicle is horizontal
+*
+*@return bool is a horizontal?
+*
+*@param v a vehicle
+*
+*@pre vehicle v
+*
+*@post whether or not they vehicle is horizontal
+*
+**/
+bool isHorizontal(const Vehicle& v){
+    return v.orientation == HORIZONTAL;
+}
+
+/**
+* print  method that prints the board
+*
+*@return void
+*
+*@param board board that the game is played on
+*
+*@pre a const board
+*
+*@post a printed 2d array
+*
+**/
+void print(const int board[][MAX_ARR]){
+    for(int i = 0; i <  6; i ++){
+        for(int j = 0; j < 6; j ++){
+            cout << board[i][j] << " ";
+        }
+        cout << endl;
+    }
+    cout << endl;
+}
+
+/**
+* fillArray  method that populates the board with 0's
+*
+*@return void
+*
+*@param board board that the game is played on
+*
+*@pre and empty board
+*
+*@post a 2d array filled with zeros
+*
+**/
+void fillArray(int board[][MAX_ARR]){
+    for(int i = 0; i <  MAX_ARR; i ++){
+        for(int j = 0; j < MAX_ARR; j ++){
+            board[i][j] = 0;
+        }
+    }
+}
+
+
+/**
+* isCollissionForward  method that indcates whether or not moving a vehicle forward results in a collision
+*
+*@return bool indicating collision course
+*
+*@param board board that the game is played on
+*
+*@param v a vehicle
+*
+*@pre vehicle v, 2d board
+*
+*@post a boolean value indicating collision
+*
+**/
+bool isCollisionForward(const Vehicle& v, const int board[][MAX_ARR]){
+    if(isHorizontal(v)){
+        if(isCar(v)){
+            if(board[v.row][v.column + CAR] != 0){
+                return true;
+            }
+        }
+        else{
+            if(board[v.row][v.column + TRUCK] != 0){
+                return true;
+            }
+        }
+    }
+    else{
+        if(isCar(v)){
+            if(board[v.row + CAR][v.column] != 0){
+                return true;
+            }
+        }
+        else{
+            if(board[v.row + TRUCK][v.column] != 0){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+/**
+* isCollissionBackwards  method that indcates whether or not moving a vehicle backwards results in a collision
+*
+*@return bool indicating collision course
+*
+*@param board board that the game is played on
+*
+*@param v a vehicle
+*
+*@pre vehicle v, 2d board
+*
+*@post a boolean value indicating collision
+*
+**/
+bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]){
+    if(isHorizontal(v)){
+        if(isCar(v)){
+            if(board[v.row][v.column - 1] != 0){
+                return true;
+            }
+        }
+        else{
+            if(board[v.row][v.column - 1] != 0){
+                return true;
+            }
+        }
+    }
+    else{
+        if(isCar(v)){
+            if(board[v.row - 1][v.column] != 0){
+                return true;
+            }
+        }
+        else{
+            if(board[v.row - 1][v.column] != 0){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+*MoveForward  method that indcates whether or not moving a vehicle forward is legal
+* and moves the car forward if so
+*
+*@return bool indicating if the vehicle was moved forward
+*
+*@param board board that the game is played on
+*
+*@param v a vehicle
+*
+*@pre vehicle v, 2d board
+*
+*@post a boolean value indicating if the car was moved. A car in a new position on the board.
+*
+**/
+bool moveForward(Vehicle& v, int board[][MAX_ARR]){
+    int set = board[v.row][v.column];
+    if(isHorizontal(v)){
+        if(isCar(v)){
+            if(v.column + CAR < MAX_ARR){
+                if(!isCollisionForward(v, board)){
+                    board[v.row][v.column] = 0;
+                    v.column++;
+                    for(int i = 0; i < CAR; i++){
+                        board[v.row][v.column + i] = set;
+                    }
+                    return true;
+                }
+            }
+        }
+        else{
+            if(v.column + TRUCK < MAX_ARR){
+                if(!isCollisionForward(v, board)){
+                    board[v.row][v.column] = 0;
+                    v.column++;
+                    for(int i = 0; i < TRUCK; i++){
+                        board[v.row][v.column + i] = set;
+                    }
+                    return true;
+                }
+            }
+        }
+    }
+    else{
+        if(isCar(v)){
+            if(v.row + CAR < MAX_ARR){
+                if(!isCollisionForward(v, board)){
+                    board[v.row][v.column] = 0;
+                    v.row++;
+                    for(int i = 0; i < CAR; i++){
+                        board[v.row + i][v.column] = set;
+                    }
+                    return true;
+                }
+            }
+        }
+        else{
+            if(v.row + TRUCK < MAX_ARR){
+                if(!isCollisionForward(v, board)){
+                    board[v.row][v.column] = 0;
+                    v.row++;
+                    for(int i = 0; i < TRUCK; i++){
+                        board[v.row + i][v.column] = set;
+                    }
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+/**
+*MoveBackward  method that indcates whether or not moving a vehicle backward is legal
+* and moves the car forward if so
+*
+*@return bool indicating if the vehicle was moved backward
+*
+*@param board board that the game is played on
+*
+*@param v a vehicle
+*
+*@pre vehicle v, 2d board
+*
+*@post a boolean value indicating if the car was moved. A car in a new position on the board.
+*
+**/
+bool moveBackward(Vehicle& v, int board[][MAX_ARR]){
+    int set = board[v.row][v.column];
+        if(isHorizontal(v)){
+            if(isCar(v)){
+                if(v.column - 1 >= 0){
+                    if(!isCollisionBackward(v, board)){
+                        board[v.row][v.column + 1] = 0;
+                        v.column--;
+                        for(int i = 0; i < CAR; i++){
+                            board[v.row][v.column + i] = set;
+                        }
+                        return true;
+                    }
+                }
+            }
+            else{
+                if(v.column - 1 >= 0){
+                    if(!isCollisionBackward(v, board)){
+                        board[v.row][v.column + 2] = 0;
+                        v.column--;
+                        for(int i = 0; i < TRUCK; i++){
+                            board[v.row][v.column + i] = set;
+                        }
+                        return true;
+                    }
+                }
+            }
+        }
+        else{
+            if(isCar(v)){
+                if(v.row - 1 >= 0){
+                    if(!isCollisionBackward(v, board)){
+                        board[v.row + 1][v.column] = 0;
+                        v.row--;
+                        for(int i = 0; i < CAR; i++){
+                            board[v.row + i][v.column] = set;
+                        }
+                        return true;
+                    }
+                }
+            }
+            else{
+                if(v.row - 1 >= 0){
+                    if(!isCollisionBackward(v, board)){
+                        board[v.row + 2][v.column] = 0;
+                        v.row--;
+                        for(int i = 0; i < TRUCK; i++){
+                            board[v.row + i][v.column] = set;
+                        }
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+}
+
+
+/**
+*isComplete used as base case. Determines whether or not to still play the game.
+*
+*@return boolean Whether or not the first car is at the far right position
+*
+*@param board board that the game is played on, unused since the position of v decides it
+*
+*@param v a vehicle
+*
+*@pre vehicle v, 2d board
+*
+*@post a boolean value indicating if the game is complete.
+*
+**/
+bool isComplete(const Vehicle& v, const int /*board*/[][MAX_ARR]){
+
+    if(isHorizontal(v)){
+        if(isCar(v)){
+            if(v.column + CAR == MAX_ARR)
+                return true;
+        }
+        else{
+            if(v.column + TRUCK == MAX_ARR){
+                return true;
+            }
+        }
+        return false;
+    }
+    else{
+        if(isCar(v)){
+            if(v.row + CAR == MAX_ARR)
+                return true;
+        }
+        else{
+            if(v.row + TRUCK == MAX_ARR){
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+/**
+*isValidScenario checks that a scenario from an untrusted source can be solved safely
+*
+*@return bool whether every vehicle is well formed, on the board and not overlapping
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars on the board
+*
+*@pre vehicles as read in
+*
+*@post none
+*
+**/
+bool isValidScenario(const Vehicle cars[], const int numCars){
+    if(numCars < 1 || numCars > MAX_VEHICLE){
+        return false;
+    }
+    int board[MAX_ARR][MAX_ARR];
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        const Vehicle& v = cars[i];
+        if(v.length != CAR && v.length != TRUCK){
+            return false;
+        }
+        if(v.orientation != HORIZONTAL && v.orientation != 'V'){
+            return false;
+        }
+        if(v.row < 0 || v.column < 0 || v.row >= MAX_ARR || v.column >= MAX_ARR){
+            return false;
+        }
+        if(isHorizontal(v) ? v.column + v.length > MAX_ARR : v.row + v.length > MAX_ARR){
+            return false;
+        }
+        for(int j = 0; j < v.length; j++){
+            int r = isHorizontal(v) ? v.row : v.row + j;
+            int c = isHorizontal(v) ? v.column + j : v.column;
+            if(board[r][c] != 0){
+                return false;
+            }
+        }
+        setBoard(board, v, i + 1);
+    }
+    return true;
+}
+
+/**
+*isProvenUnsolvable  cheap check for boards where the first car can never reach the exit.
+*Each vehicle gets a range of offsets that grows from where it starts until it runs into
+*a square some other vehicle covers at every offset of its own range, or into the range
+*of a vehicle sharing its lane (which it can never pass). At the fixed point no vehicle can
+*leave its range, so if the first car's range stops short of the exit there is no solution.
+*This catches a vehicle sharing the first car's lane ahead of it as well as blockers that
+*pin each other in place.
+*
+*@return bool true only if the scenario certainly has no solution
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars on the board
+*
+*@pre vehicles that do not overlap
+*
+*@post none
+*
+**/
+bool isProvenUnsolvable(const Vehicle cars[], const int numCars){
+    int start[MAX_VEHICLE];
+    int low[MAX_VEHICLE];
+    int high[MAX_VEHICLE];
+    for(int i = 0; i < numCars; i++){
+        start[i] = isHorizontal(cars[i]) ? cars[i].column : cars[i].row;
+        low[i] = start[i];
+        high[i] = start[i];
+    }
+    bool grown = true;
+    while(grown){
+        grown = false;
+        //squares covered by a vehicle wherever it is in its range
+        int fixed[MAX_ARR][MAX_ARR];
+        fillArray(fixed);
+        for(int i = 0; i < numCars; i++){
+            for(int k = high[i]; k < low[i] + cars[i].length; k++){
+                if(isHorizontal(cars[i])){
+                    fixed[cars[i].row][k] = i + 1;
+                }
+                else{
+                    fixed[k][cars[i].column] = i + 1;
+                }
+            }
+        }
+        for(int w = 0; w < numCars; w++){
+            const Vehicle& v = cars[w];
+            int lane = isHorizontal(v) ? v.row : v.column;
+            int first = 0;
+            int last = MAX_ARR - v.length;
+            for(int u = 0; u < numCars; u++){
+                if(u == w || cars[u].orientation != v.orientation ||
+                   (isHorizontal(cars[u]) ? cars[u].row : cars[u].column) != lane){
+                    continue;
+                }
+                if(start[u] > start[w]){
+                    last = min(last, high[u] - v.length);
+                }
+                else{
+                    first = max(first, low[u] + cars[u].length);
+                }
+            }
+            int up = high[w];
+            while(up < last){
+                int cell = isHorizontal(v) ? fixed[lane][up + v.length] : fixed[up + v.length][lane];
+                if(cell != 0 && cell != w + 1){
+                    break;
+                }
+                up++;
+            }
+            int down = low[w];
+            while(down > first){
+                int cell = isHorizontal(v) ? fixed[lane][down - 1] : fixed[down - 1][lane];
+                if(cell != 0 && cell != w + 1){
+                    break;
+                }
+                down--;
+            }
+            if(up > high[w] || down < low[w]){
+                high[w] = up;
+                low[w] = down;
+                grown = true;
+            }
+        }
+    }
+    return high[0] < MAX_ARR - cars[0].length;
+}
+
+/**
+*blockers  method that gives a lower bound on the moves left: the first car still has to
+*slide to the edge one square at a time and every vehicle in its way has to move at least once
+*
+*@return int admissible estimate of the moves needed
+*
+*@param cars an array containing every car on the board
+*
+*@param board board that the game is played on
+*
+**/
+int blockers(const Vehicle cars[], const int board[][MAX_ARR]){
+    const Vehicle& v = cars[0];
+    int estimate = 0;
+    int last = 0;
+    if(isHorizontal(v)){
+        estimate = MAX_ARR - v.length - v.column;
+        for(int c = v.column + v.length; c < MAX_ARR; c++){
+            if(board[v.row][c] != 0 && board[v.row][c] != last){
+                last = board[v.row][c];
+                estimate++;
+            }
+        }
+    }
+    else{
+        estimate = MAX_ARR - v.length - v.row;
+        for(int r = v.row + v.length; r < MAX_ARR; r++){
+            if(board[r][v.column] != 0 && board[r][v.column] != last){
+                last = board[r][v.column];
+                estimate++;
+            }
+        }
+    }
+    return estimate;
+}
+
+/**
+* VisitedTable constructor that allocates an empty table
+*
+*@pre none
+*
+*@post a table with no keys in the current generation
+*
+**/
+VisitedTable::VisitedTable(){
+    keys.assign(1024, 0);
+    stamps.assign(1024, 0);
+    generation = 1;
+    count = 0;
+    mask = keys.size() - 1;
+    shift = 64 - 10;
+}
+
+/**
+* clear  method that forgets every key without releasing or touching the slots
+*
+*@return void
+*
+*@pre a table from a previous scenario
+*
+*@post an empty table that keeps its capacity
+*
+**/
+void VisitedTable::clear(){
+    generation++;
+    if(generation == 0){
+        //the stamps wrapped around, so old stamps could look current again
+        stamps.assign(stamps.size(), 0);
+        generation = 1;
+    }
+    count = 0;
+}
+
+/**
+* slotFor  method that hashes a key to its home slot
+*
+*@return size_t the first slot to probe
+*
+*@param key a packed state
+*
+**/
+size_t VisitedTable::slotFor(StateKey key) const{
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> shift);
+}
+
+/**
+* insert  method that adds a key to the table if it is not already there
+*
+*@return bool indicating the key was new
+*
+*@param key a packed state
+*
+*@pre a table
+*
+*@post the key is in the table
+*
+**/
+bool VisitedTable::insert(StateKey key){
+    if((count + 1) * 2 > keys.size()){
+        grow();
+    }
+    size_t slot = slotFor(key);
+    while(stamps[slot] == generation){
+        if(keys[slot] == key){
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    stamps[slot] = generation;
+    keys[slot] = key;
+    count++;
+    return true;
+}
+
+/**
+* prefetch  method that starts loading the slot a key hashes to, ahead of insert
+*
+*@return void
+*
+*@param key the packed state about to be inserted
+*
+**/
+void VisitedTable::prefetch(StateKey key) const{
+    size_t slot = slotFor(key);
+    __builtin_prefetch(&stamps[slot]);
+    __builtin_prefetch(&keys[slot]);
+}
+
+/**
+* contains  method that checks whether a key was already inserted
+*
+*@return bool indicating the key is in the table
+*
+*@param key a packed state
+*
+**/
+bool VisitedTable::contains(StateKey key) const{
+    size_t slot = slotFor(key);
+    while(stamps[slot] == generation){
+        if(keys[slot] == key){
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+/**
+* size  method that returns the number of keys in the current generation
+*
+*@return size_t number of keys
+*
+**/
+size_t VisitedTable::size() const{
+    return count;
+}
+
+/**
+* list  method that appends every key in the current generation
+*
+*@return void
+*
+*@param out keys are appended in slot order
+*
+**/
+void VisitedTable::list(vector<StateKey>& out) const{
+    for(size_t i = 0; i < keys.size(); i++){
+        if(stamps[i] == generation){
+            out.push_back(keys[i]);
+        }
+    }
+}
+
+/**
+* grow  method that doubles the table and rehashes the live keys
+*
+*@return void
+*
+*@pre a table at its load limit
+*
+*@post a table twice the size holding the same keys
+*
+**/
+void VisitedTable::grow(){
+    vector<StateKey, HugePageAllocator<StateKey> > oldKeys(keys.size() * 2, 0);
+    vector<uint32_t, HugePageAllocator<uint32_t> > oldStamps(stamps.size() * 2, 0);
+    oldKeys.swap(keys);
+    oldStamps.swap(stamps);
+    mask = keys.size() - 1;
+    shift--;
+    uint32_t live = generation;
+    generation = 1;
+    for(size_t i = 0; i < oldKeys.size(); i++){
+        if(oldStamps[i] == live){
+            size_t slot = slotFor(oldKeys[i]);
+            while(stamps[slot] == generation){
+                slot = (slot + 1) & mask;
+            }
+            stamps[slot] = generation;
+            keys[slot] = oldKeys[i];
+        }
+    }
+}
+
+/**
+* VisitedBitmap constructor
+*
+*@pre none
+*
+*@post an empty bitmap with no capacity
+*
+**/
+VisitedBitmap::VisitedBitmap(){
+    count = 0;
+}
+
+/**
+* resize  method that makes room for a rank space, keeping the bits if they are big enough
+*
+*@return void
+*
+*@param numStates number of possible ranks
+*
+*@pre a cleared bitmap
+*
+*@post a cleared bitmap covering every rank below numStates
+*
+**/
+void VisitedBitmap::resize(uint64_t numStates){
+    size_t words = (size_t)((numStates + 63) / 64);
+    if(words > bits.size()){
+        bits.assign(words, 0);
+        dirty.clear();
+    }
+}
+
+/**
+* clear  method that zeroes only the words set since the last clear
+*
+*@return void
+*
+*@pre a bitmap from a previous scenario
+*
+*@post an empty bitmap that keeps its capacity
+*
+**/
+void VisitedBitmap::clear(){
+    for(size_t i = 0; i < dirty.size(); i++){
+        bits[dirty[i]] = 0;
+    }
+    dirty.clear();
+    count = 0;
+}
+
+/**
+* insert  method that sets the bit of a rank
+*
+*@return bool indicating the bit was not set before
+*
+*@param rank a state's rank
+*
+*@pre rank is inside the size given to resize
+*
+*@post the bit is set
+*
+**/
+bool VisitedBitmap::insert(uint64_t rank){
+    uint64_t& word = bits[rank >> 6];
+    uint64_t bit = 1ULL << (rank & 63);
+    if(word & bit){
+        return false;
+    }
+    if(word == 0){
+        dirty.push_back(rank >> 6);
+    }
+    word |= bit;
+    count++;
+    return true;
+}
+
+/**
+* prefetch  method that starts loading the word of a rank, ahead of insert
+*
+*@return void
+*
+*@param rank the rank about to be inserted
+*
+**/
+void VisitedBitmap::prefetch(uint64_t rank) const{
+    __builtin_prefetch(&bits[rank >> 6]);
+}
+
+/**
+* size  method that returns the number of set bits
+*
+*@return size_t number of states marked
+*
+**/
+size_t VisitedBitmap::size() const{
+    return count;
+}
+
+/**
+* list  method that appends the rank of every set bit
+*
+*@return void
+*
+*@param out ranks are appended a word at a time
+*
+**/
+void VisitedBitmap::list(vector<uint64_t>& out) const{
+    for(size_t i = 0; i < dirty.size(); i++){
+        uint64_t word = bits[dirty[i]];
+        while(word != 0){
+            out.push_back((uint64_t)dirty[i] * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+/**
+* FrontierBuffer constructor
+*
+*@pre none
+*
+*@post an empty frontier
+*
+**/
+FrontierBuffer::FrontierBuffer(){
+    count = 0;
+}
+
+/**
+* clear  method that empties the frontier but keeps its buffers
+*
+*@return void
+*
+*@post an empty frontier
+*
+**/
+void FrontierBuffer::clear(){
+    staging.clear();
+    data.clear();
+    blockStart.clear();
+    blockSize.clear();
+    count = 0;
+}
+
+/**
+* push  method that adds a value, compressing a run once enough are staged
+*
+*@return void
+*
+*@param value a state rank
+*
+*@post the value will be read back by readBlock
+*
+**/
+void FrontierBuffer::push(uint64_t value){
+    staging.push_back(value);
+    count++;
+    if(staging.size() == FRONTIER_RUN){
+        compressRun();
+    }
+}
+
+/**
+* encodeBlocks  method that appends sorted values as compressed blocks
+*
+*@return void
+*
+*@param values sorted values
+*
+*@param count number of values
+*
+*@param data compressed blocks, appended to
+*
+*@param blockStart offset of each block in data, appended to
+*
+*@param blockSize number of values in each block, appended to
+*
+**/
+static void encodeBlocks(const uint64_t* values, size_t count, vector<uint8_t, HugePageAllocator<uint8_t> >& data,
+                         vector<size_t, HugePageAllocator<size_t> >& blockStart,
+                         vector<uint16_t, HugePageAllocator<uint16_t> >& blockSize){
+    for(size_t first = 0; first < count; first += FRONTIER_BLOCK){
+        size_t last = min(count, first + FRONTIER_BLOCK);
+        blockStart.push_back(data.size());
+        blockSize.push_back((uint16_t)(last - first));
+        uint64_t previous = 0;
+        for(size_t i = first; i < last; i++){
+            //the first value of a block is stored whole so blocks decode independently
+            uint64_t delta = values[i] - previous;
+            previous = values[i];
+            while(delta >= 0x80){
+                data.push_back((uint8_t)(delta | 0x80));
+                delta >>= 7;
+            }
+            data.push_back((uint8_t)delta);
+        }
+    }
+}
+
+/**
+* compressRun  method that sorts the staged values and appends them as compressed blocks
+*
+*@return void
+*
+*@pre distinct staged values
+*
+*@post no staged values
+*
+**/
+void FrontierBuffer::compressRun(){
+    sort(staging.begin(), staging.end());
+    encodeBlocks(staging.data(), staging.size(), data, blockStart, blockSize);
+    staging.clear();
+}
+
+//a position in one sorted run of a FrontierBuffer being merged
+struct RunCursor{
+    size_t block;       //next block to open
+    size_t end;         //block past the run
+    int left;           //values left in the open block
+    const uint8_t* p;   //next byte of the open block
+    uint64_t value;     //last value decoded
+};
+
+/**
+* advanceRun  method that decodes the next value of a run
+*
+*@return bool false once the run is used up
+*
+*@param run the cursor, whose value is set
+*
+*@param data compressed blocks
+*
+*@param blockStart offset of each block in data
+*
+*@param blockSize number of values in each block
+*
+**/
+static bool advanceRun(RunCursor& run, const vector<uint8_t, HugePageAllocator<uint8_t> >& data,
+                       const vector<size_t, HugePageAllocator<size_t> >& blockStart,
+                       const vector<uint16_t, HugePageAllocator<uint16_t> >& blockSize){
+    if(run.left == 0){
+        if(run.block == run.end){
+            return false;
+        }
+        run.p = &data[blockStart[run.block]];
+        run.left = blockSize[run.block];
+        run.value = 0;
+        run.block++;
+    }
+    uint64_t delta = 0;
+    int shift = 0;
+    while(*run.p & 0x80){
+        delta |= (uint64_t)(*run.p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    delta |= (uint64_t)(*run.p++) << shift;
+    run.value += delta;
+    run.left--;
+    return true;
+}
+
+/**
+* finish  method that merges the sorted runs of a complete level into one sorted sequence,
+* decoding each run one value at a time so only the merged copy is extra
+*
+*@return void
+*
+*@pre every value of the level has been pushed
+*
+*@post the blocks hold the level in ascending order; a level that never filled a run is
+*left as it is
+*
+**/
+void FrontierBuffer::finish(){
+    if(blockStart.empty()){
+        return;
+    }
+    if(!staging.empty()){
+        compressRun();
+    }
+    //every run but the last fills FRONTIER_RUN / FRONTIER_BLOCK blocks
+    const size_t runBlocks = FRONTIER_RUN / FRONTIER_BLOCK;
+    size_t numRuns = (blockStart.size() + runBlocks - 1) / runBlocks;
+    if(numRuns == 1){
+        return;
+    }
+    vector<RunCursor> runs(numRuns);
+    typedef pair<uint64_t, size_t> Head;     //a run's smallest unmerged value and the run
+    priority_queue<Head, vector<Head>, greater<Head> > heads;
+    for(size_t r = 0; r < numRuns; r++){
+        runs[r].block = r * runBlocks;
+        runs[r].end = min(blockStart.size(), runs[r].block + runBlocks);
+        runs[r].left = 0;
+        if(advanceRun(runs[r], data, blockStart, blockSize)){
+            heads.push(make_pair(runs[r].value, r));
+        }
+    }
+
+    vector<uint8_t, HugePageAllocator<uint8_t> > merged;
+    vector<size_t, HugePageAllocator<size_t> > mergedStart;
+    vector<uint16_t, HugePageAllocator<uint16_t> > mergedSize;
+    merged.reserve(data.size());
+    uint64_t out[FRONTIER_BLOCK];
+    size_t pending = 0;
+    while(!heads.empty()){
+        Head head = heads.top();
+        heads.pop();
+        out[pending++] = head.first;
+        if(pending == FRONTIER_BLOCK){
+            encodeBlocks(out, pending, merged, mergedStart, mergedSize);
+            pending = 0;
+        }
+        if(advanceRun(runs[head.second], data, blockStart, blockSize)){
+            heads.push(make_pair(runs[head.second].value, head.second));
+        }
+    }
+    encodeBlocks(out, pending, merged, mergedStart, mergedSize);
+    data.swap(merged);
+    blockStart.swap(mergedStart);
+    blockSize.swap(mergedSize);
+}
+
+/**
+* size  method that returns the number of values pushed
+*
+*@return size_t number of values
+*
+**/
+size_t FrontierBuffer::size() const{
+    return count;
+}
+
+/**
+* empty  method that tells whether any value was pushed
+*
+*@return bool no values
+*
+**/
+bool FrontierBuffer::empty() const{
+    return count == 0;
+}
+
+/**
+* bytes  method that reports the memory holding the values
+*
+*@return size_t bytes of compressed and staged values
+*
+**/
+size_t FrontierBuffer::bytes() const{
+    return data.size() + staging.size() * sizeof(uint64_t) +
+           blockStart.size() * (sizeof(size_t) + sizeof(uint16_t));
+}
+
+/**
+* blockCount  method that returns how many blocks readBlock can return
+*
+*@return size_t compressed blocks followed by the staged values in blocks
+*
+**/
+size_t FrontierBuffer::blockCount() const{
+    return blockStart.size() + (staging.size() + FRONTIER_BLOCK - 1) / FRONTIER_BLOCK;
+}
+
+/**
+* readBlock  method that decodes one block of values
+*
+*@return void
+*
+*@param block index below blockCount
+*
+*@param out replaced with the block's values
+*
+**/
+void FrontierBuffer::readBlock(size_t block, RankBlock& out) const{
+    out.clear();
+    if(block >= blockStart.size()){
+        size_t first = (block - blockStart.size()) * FRONTIER_BLOCK;
+        size_t last = min(staging.size(), first + FRONTIER_BLOCK);
+        out.insert(out.end(), staging.begin() + first, staging.begin() + last);
+        return;
+    }
+    const uint8_t* p = &data[blockStart[block]];
+    uint64_t value = 0;
+    for(int i = 0; i < blockSize[block]; i++){
+        uint64_t delta = 0;
+        int shift = 0;
+        while(*p & 0x80){
+            delta |= (uint64_t)(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        delta |= (uint64_t)(*p++) << shift;
+        value += delta;
+        out.push_back(value);
+    }
+}
+
+/**
+* swap  method that exchanges the contents of two frontiers
+*
+*@return void
+*
+*@param other the frontier to swap with
+*
+**/
+void FrontierBuffer::swap(FrontierBuffer& other){
+    staging.swap(other.staging);
+    data.swap(other.data);
+    blockStart.swap(other.blockStart);
+    blockSize.swap(other.blockSize);
+    std::swap(count, other.count);
+}
+
+/**
+* Solver constructor
+*
+*@pre none
+*
+*@post a solver ready for its first scenario
+*
+**/
+Solver::Solver(){
+    numCars = 0;
+    backend = VISITED_AUTO;
+    dense = false;
+    budgetSeconds = 0;
+    budgetNodes = 0;
+    setProbeBatch(PROBE_BATCH);
+    cancel = NULL;
+    checkpointSeconds = CHECKPOINT_SECONDS;
+    resume = NULL;
+    memoryLimit = 0;
+    capped = false;
+    memset(board, 0, sizeof(board));
+}
+
+/**
+* reset  method that drops the previous scenario while keeping every buffer allocated
+*
+*@return void
+*
+*@pre a solver that may hold a previous search
+*
+*@post an empty frontier and visited table with their capacity intact
+*
+**/
+void Solver::reset(){
+    batchKeys.clear();
+    batchRanks.clear();
+    frontier.clear();
+    next.clear();
+    visited.clear();
+    bitmap.clear();
+}
+
+/**
+* release  method that frees the frontiers and visited sets, so a search under the memory
+* limit starts from nothing and one that reached it gives its memory back
+*
+*@return void
+*
+*@post every table is back to its initial size
+*
+**/
+void Solver::release(){
+    batchKeys.clear();
+    batchRanks.clear();
+    frontier = FrontierBuffer();
+    next = FrontierBuffer();
+    visited = VisitedTable();
+    bitmap = VisitedBitmap();
+    beamVisited = VisitedTable();
+    dense = false;
+}
+
+/**
+* statesVisited  method that reports how many states the last solve discovered
+*
+*@return size_t number of distinct states
+*
+**/
+size_t Solver::statesVisited() const{
+    return dense ? bitmap.size() : visited.size();
+}
+
+/**
+* setVisitedBackend  method that picks how later solves remember visited states
+*
+*@return void
+*
+*@param backend hash table, bitmap when the rank space is at most DENSE_MAX_STATES, or
+*automatic (bitmap when the rank space is at most DENSE_AUTO_STATES)
+*
+**/
+void Solver::setVisitedBackend(VisitedBackend backend){
+    this->backend = backend;
+}
+
+/**
+* load  method that copies a scenario into the solver
+*
+*@return void
+*
+*@param cars the vehicles as read in
+*
+*@param numCars number of vehicles
+*
+*@pre vehicles that do not overlap
+*
+*@post the solver holds the scenario, its vehicle table and its visited backend
+*
+**/
+void Solver::load(const Vehicle cars[], const int numCars){
+    this->numCars = numCars;
+    //each vehicle has MAX_ARR - length + 1 offsets, so states form a mixed radix range
+    uint64_t numStates = 1;
+    for(int i = 0; i < numCars; i++){
+        puzzle[i] = cars[i];
+        table.length[i] = cars[i].length;
+        table.radix[i] = MAX_ARR - cars[i].length + 1;
+        table.base[i] = isHorizontal(cars[i]) ? cars[i].row * MAX_ARR : cars[i].column;
+        table.stride[i] = isHorizontal(cars[i]) ? 1 : MAX_ARR;
+        weight[i] = numStates;
+        numStates *= table.radix[i];
+    }
+    dense = (backend == VISITED_DENSE && numStates <= DENSE_MAX_STATES) ||
+            (backend == VISITED_AUTO && numStates <= DENSE_AUTO_STATES);
+    if(dense){
+        try{
+            bitmap.resize(numStates);
+        }
+        catch(const bad_alloc&){
+            //a bitmap that would not fit under the memory limit leaves the hash table
+            dense = false;
+        }
+    }
+}
+
+/**
+* encode  method that packs the lane offset of every vehicle into a key
+*
+*@return StateKey the packed state
+*
+*@param cars vehicles in some state of the current scenario
+*
+**/
+StateKey Solver::encode(const Vehicle cars[]) const{
+    StateKey key = 0;
+    for(int i = 0; i < numCars; i++){
+        StateKey offset = isHorizontal(cars[i]) ? cars[i].column : cars[i].row;
+        key |= offset << (KEY_BITS * i);
+    }
+    return key;
+}
+
+/**
+* decode  method that unpacks a rank into the scratch offsets and board
+*
+*@return StateKey the packed key of the state
+*
+*@param rank the rank of a state of the current scenario
+*
+*@post scratch offsets and board describe the state
+*
+**/
+StateKey Solver::decode(uint64_t rank){
+    memset(board, 0, sizeof(board));
+    StateKey key = 0;
+    for(int i = 0; i < numCars; i++){
+        int position = (int)(rank % table.radix[i]);
+        rank /= table.radix[i];
+        offset[i] = position;
+        key |= (StateKey)position << (KEY_BITS * i);
+        for(int k = 0; k < table.length[i]; k++){
+            board[table.base[i] + (position + k) * table.stride[i]] = i + 1;
+        }
+    }
+    return key;
+}
+
+/**
+* rankOf  method that maps a key to its dense index in the mixed radix range
+*
+*@return uint64_t the rank
+*
+*@param key a packed state of the current scenario
+*
+**/
+uint64_t Solver::rankOf(StateKey key) const{
+    uint64_t rank = 0;
+    for(int i = 0; i < numCars; i++){
+        rank += ((key >> (KEY_BITS * i)) & 7) * weight[i];
+    }
+    return rank;
+}
+
+/**
+* markVisited  method that records a state in the scenario's visited backend
+*
+*@return bool indicating the state had not been visited
+*
+*@param key the packed state
+*
+*@param rank the state's rank, only used by the bitmap
+*
+**/
+inline bool Solver::markVisited(StateKey key, uint64_t rank){
+    return dense ? bitmap.insert(rank) : visited.insert(key);
+}
+
+/**
+* prefetchVisited  method that starts loading where a state lives in the visited backend
+*
+*@return void
+*
+*@param key the packed state
+*
+*@param rank the state's rank
+*
+**/
+inline void Solver::prefetchVisited(StateKey key, uint64_t rank) const{
+    if(dense){
+        bitmap.prefetch(rank);
+    }
+    else{
+        visited.prefetch(key);
+    }
+}
+
+/**
+* probeBatch  method that probes the visited set for every batched child, whose slots were
+* prefetched when they were generated, and queues the new ones for the next level
+*
+*@return void
+*
+*@post the batch is empty
+*
+**/
+void Solver::probeBatch(){
+    for(size_t c = 0; c < batchKeys.size(); c++){
+        if(markVisited(batchKeys[c], batchRanks[c])){
+            next.push(batchRanks[c]);
+        }
+    }
+    batchKeys.clear();
+    batchRanks.clear();
+}
+
+/**
+* slideForward  method that moves a scratch vehicle one square forward if it can
+*
+*@return bool indicating the vehicle moved
+*
+*@param i the vehicle
+*
+**/
+inline bool Solver::slideForward(int i){
+    int end = offset[i] + table.length[i];
+    if(end >= MAX_ARR || board[table.base[i] + end * table.stride[i]] != 0){
+        return false;
+    }
+    board[table.base[i] + offset[i] * table.stride[i]] = 0;
+    board[table.base[i] + end * table.stride[i]] = i + 1;
+    offset[i]++;
+    return true;
+}
+
+/**
+* slideBackward  method that moves a scratch vehicle one square backward if it can
+*
+*@return bool indicating the vehicle moved
+*
+*@param i the vehicle
+*
+**/
+inline bool Solver::slideBackward(int i){
+    if(offset[i] == 0 || board[table.base[i] + (offset[i] - 1) * table.stride[i]] != 0){
+        return false;
+    }
+    offset[i]--;
+    board[table.base[i] + offset[i] * table.stride[i]] = i + 1;
+    board[table.base[i] + (offset[i] + table.length[i]) * table.stride[i]] = 0;
+    return true;
+}
+
+/**
+* complete  method that checks whether the first scratch vehicle is at the exit
+*
+*@return bool whether the scratch state is a goal
+*
+**/
+inline bool Solver::complete() const{
+    return offset[0] + table.length[0] == MAX_ARR;
+}
+
+/**
+* blocking  method that gives the scratch state's blockers estimate (see blockers)
+*
+*@return int admissible estimate of the moves left
+*
+**/
+int Solver::blocking() const{
+    int estimate = MAX_ARR - table.length[0] - offset[0];
+    int last = 0;
+    for(int position = offset[0] + table.length[0]; position < MAX_ARR; position++){
+        int cell = board[table.base[0] + position * table.stride[0]];
+        if(cell != 0 && cell != last){
+            last = cell;
+            estimate++;
+        }
+    }
+    return estimate;
+}
+
+/**
+* setBudget  method that limits how long solveBounded searches before settling for bounds
+*
+*@return void
+*
+*@param seconds wall clock time per scenario, 0 for no limit
+*
+*@param nodes states expanded per scenario, 0 for no limit
+*
+**/
+void Solver::setBudget(double seconds, uint64_t nodes){
+    budgetSeconds = seconds;
+    budgetNodes = nodes;
+}
+
+/**
+* setProbeBatch  method that sets how many children are generated and prefetched before the
+* visited set is probed for them
+*
+*@return void
+*
+*@param children batch size, 1 probes after every state
+*
+**/
+void Solver::setProbeBatch(size_t children){
+    batchSize = children < 1 ? 1 : children;
+    batchKeys.reserve(batchSize + 2 * MAX_VEHICLE);
+    batchRanks.reserve(batchSize + 2 * MAX_VEHICLE);
+}
+
+/**
+* setCancel  method that lets another thread stop later searches
+*
+*@return void
+*
+*@param cancel flag checked between frontier blocks, NULL to never stop early
+*
+**/
+void Solver::setCancel(const atomic<bool>* cancel){
+    this->cancel = cancel;
+}
+
+/**
+* setMemoryLimit  method that caps what later solves may allocate for their tables
+*
+*@return void
+*
+*@param bytes the most one search may allocate through HugePageAllocator, 0 for no limit
+*
+*@post the visited set, the frontiers and their staging, the expanded block and the probe
+*batch all count. Not counted: checkpoint copies (8 bytes per visited state while one is
+*written), pattern databases, the beam's level lists (under 1 MB at BEAM_WIDTH)
+*and small containers, so the real peak can pass the cap by that much.
+*
+**/
+void Solver::setMemoryLimit(size_t bytes){
+    memoryLimit = bytes;
+}
+
+/**
+* memoryCapped  method that tells whether the last solve stopped at the memory limit
+*
+*@return bool true if the search was abandoned and its tables released; solve then
+*returned false without proving anything
+*
+**/
+bool Solver::memoryCapped() const{
+    return capped;
+}
+
+/**
+* setCheckpoint  method that makes later searches save themselves at level boundaries
+*
+*@return void
+*
+*@param path file each checkpoint replaces, empty to stop checkpointing
+*
+*@param seconds least time between two checkpoints of a search
+*
+**/
+void Solver::setCheckpoint(const string& path, double seconds){
+    checkpointPath = path;
+    checkpointSeconds = seconds;
+}
+
+/**
+* setResume  method that lets a later search continue from a checkpoint
+*
+*@return void
+*
+*@param checkpoint read by readCheckpoint and kept alive by the caller; the first solve of
+*the same scenario starts from it, NULL to start every search afresh
+*
+**/
+void Solver::setResume(const Checkpoint* checkpoint){
+    resume = checkpoint;
+}
+
+/**
+* restore  method that loads the resume checkpoint if it is of the loaded scenario
+*
+*@return bool indicating the search was restored
+*
+*@param depth set to the checkpoint's level
+*
+*@pre a loaded scenario and an empty frontier and visited set
+*
+*@post the checkpoint is used up
+*
+**/
+bool Solver::restore(int& depth){
+    if(resume == NULL || resume->numCars != numCars){
+        return false;
+    }
+    for(int i = 0; i < numCars; i++){
+        const Vehicle& v = resume->cars[i];
+        if(v.length != puzzle[i].length || v.orientation != puzzle[i].orientation ||
+           v.row != puzzle[i].row || v.column != puzzle[i].column){
+            return false;
+        }
+    }
+    //readCheckpoint checks the ranks, but nothing may index past the table on a bad one
+    uint64_t numStates = weight[numCars - 1] * table.radix[numCars - 1];
+    for(size_t v = 0; v < resume->visited.size(); v++){
+        if(resume->visited[v] >= numStates){
+            resume = NULL;
+            return false;
+        }
+    }
+    for(size_t f = 0; f < resume->frontier.size(); f++){
+        if(resume->frontier[f] >= numStates){
+            resume = NULL;
+            return false;
+        }
+    }
+    for(size_t v = 0; v < resume->visited.size(); v++){
+        markVisited(decode(resume->visited[v]), resume->visited[v]);
+    }
+    for(size_t f = 0; f < resume->frontier.size(); f++){
+        frontier.push(resume->frontier[f]);
+    }
+    frontier.finish();
+    depth = resume->depth;
+    resume = NULL;
+    return true;
+}
+
+/**
+* snapshot  method that copies the search at a level boundary and hands it to the writer
+*
+*@return void
+*
+*@param depth the level the frontier holds
+*
+**/
+void Solver::snapshot(int depth){
+    saved.numCars = numCars;
+    for(int i = 0; i < numCars; i++){
+        saved.cars[i] = puzzle[i];
+    }
+    saved.depth = depth;
+    saved.frontier.clear();
+    for(size_t b = 0; b < frontier.blockCount(); b++){
+        frontier.readBlock(b, block);
+        saved.frontier.insert(saved.frontier.end(), block.begin(), block.end());
+    }
+    saved.visited.clear();
+    if(dense){
+        bitmap.list(saved.visited);
+    }
+    else{
+        visited.list(saved.visited);
+        for(size_t v = 0; v < saved.visited.size(); v++){
+            saved.visited[v] = rankOf(saved.visited[v]);
+        }
+    }
+    writer.write(checkpointPath, saved);
+}
+
+/**
+*solve  method that runs a level by level BFS and calculates the minimum possible
+*moves it requires to complete the game (if such moves exist)
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@pre vehicles that do not overlap
+*
+*@post the frontier and visited table hold the finished search until the next reset, or are
+*released if they reached the memory limit (see memoryCapped)
+*
+**/
+bool Solver::solve(const Vehicle cars[], const int numCars, int& moves){
+    reset();
+    capped = false;
+    //the cap only counts what the search allocates, so it starts from empty tables
+    if(memoryLimit != 0){
+        release();
+    }
+    try{
+        MemoryCap cap(memoryLimit);
+        load(cars, numCars);
+        if(isProvenUnsolvable(cars, numCars)){
+            return false;
+        }
+        return search(false, moves) == SOLVE_EXACT;
+    }
+    catch(const bad_alloc&){
+        release();
+        capped = true;
+        return false;
+    }
+}
+
+/**
+*solveBounded  method that runs the BFS within the budget. If the budget runs out the
+*levels fully expanded give a lower bound and a beam search looks for an upper bound.
+*
+*@return SolveResult exact, unsolvable, or the best bounds known
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@pre vehicles that do not overlap
+*
+*@post the frontier and visited table hold the search until the next reset, or are released
+*if they reached the memory limit
+*
+**/
+SolveResult Solver::solveBounded(const Vehicle cars[], const int numCars){
+    reset();
+    capped = false;
+    //the cap only counts what the search allocates, so it starts from empty tables
+    if(memoryLimit != 0){
+        release();
+    }
+    SolveResult result;
+    //search sets it to the levels fully searched; -1 until the start state is checked
+    result.lower = -1;
+    try{
+        MemoryCap cap(memoryLimit);
+        load(cars, numCars);
+        if(isProvenUnsolvable(cars, numCars)){
+            result.status = SOLVE_UNSOLVABLE;
+            result.lower = -1;
+            result.upper = -1;
+            return result;
+        }
+        result.status = search(true, result.lower);
+    }
+    catch(const bad_alloc&){
+        //the levels up to the frontier were searched in full without a goal; if the cap
+        //was reached before the start state was even checked, nothing is proven
+        release();
+        capped = true;
+        result.status = SOLVE_BOUNDED;
+        result.lower = result.lower < 0 ? 0 : result.lower + 1;
+    }
+    if(result.status == SOLVE_UNSOLVABLE){
+        result.lower = -1;
+    }
+    result.upper = result.status == SOLVE_EXACT ? result.lower : -1;
+    if(result.status == SOLVE_BOUNDED && (cancel == NULL || !cancel->load(memory_order_relaxed))){
+        try{
+            MemoryCap cap(memoryLimit);
+            result.upper = beamSearch();
+        }
+        catch(const bad_alloc&){
+            beamVisited = VisitedTable();
+        }
+        //the beam can happen on a shortest solution
+        if(result.upper == result.lower){
+            result.status = SOLVE_EXACT;
+        }
+    }
+    return result;
+}
+
+/**
+*search  method that runs the level by level BFS over the loaded scenario
+*
+*@return SolveStatus exact, unsolvable, or bounded when the budget ran out or it was cancelled
+*
+*@param budgeted whether the budget applies
+*
+*@param depth the minimum number of moves when exact, the lower bound when bounded
+*
+*@pre a loaded scenario and an empty frontier and visited set
+*
+*@post the frontier and visited table hold the search
+*
+**/
+SolveStatus Solver::search(bool budgeted, int& depth){
+    if(!restore(depth)){
+        uint64_t start = rankOf(encode(puzzle));
+        markVisited(decode(start), start);
+        depth = 0;
+        if(complete()){
+            return SOLVE_EXACT;
+        }
+        frontier.push(start);
+    }
+
+    typedef chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(budgetSeconds));
+    Clock::duration interval = chrono::duration_cast<Clock::duration>(chrono::duration<double>(checkpointSeconds));
+    Clock::time_point lastCheckpoint = Clock::now();
+    uint64_t expanded = 0;
+    while(!frontier.empty()){
+        for(size_t b = 0; b < frontier.blockCount(); b++){
+            //every level up to depth has been expanded without reaching the goal
+            if((budgeted && ((budgetNodes != 0 && expanded >= budgetNodes) ||
+                             (budgetSeconds > 0 && Clock::now() >= deadline))) ||
+               (cancel != NULL && cancel->load(memory_order_relaxed))){
+                depth++;
+                return SOLVE_BOUNDED;
+            }
+            frontier.readBlock(b, block);
+            expanded += block.size();
+            for(size_t f = 0; f < block.size(); f++){
+                uint64_t rank = block[f];
+                StateKey key = decode(rank);
+                //move every piece in place, batch the child and undo the move. A goal has
+                //never been visited, since the search would have stopped there already.
+                for(int i = 0; i < numCars; i++){
+                    StateKey step = StateKey(1) << (KEY_BITS * i);
+                    if(slideForward(i)){
+                        if(i == 0 && complete()){
+                            batchKeys.clear();
+                            batchRanks.clear();
+                            depth++;
+                            return SOLVE_EXACT;
+                        }
+                        prefetchVisited(key + step, rank + weight[i]);
+                        batchKeys.push_back(key + step);
+                        batchRanks.push_back(rank + weight[i]);
+                        slideBackward(i);
+                    }
+                    if(slideBackward(i)){
+                        prefetchVisited(key - step, rank - weight[i]);
+                        batchKeys.push_back(key - step);
+                        batchRanks.push_back(rank - weight[i]);
+                        slideForward(i);
+                    }
+                }
+                if(batchKeys.size() >= batchSize){
+                    probeBatch();
+                }
+            }
+        }
+        probeBatch();
+        next.finish();
+        frontier.swap(next);
+        next.clear();
+        depth++;
+        if(!checkpointPath.empty() && !frontier.empty() && Clock::now() - lastCheckpoint >= interval){
+            snapshot(depth);
+            lastCheckpoint = Clock::now();
+        }
+    }
+    return SOLVE_UNSOLVABLE;
+}
+
+/**
+*beamSearch  method that looks for any solution by keeping only the BEAM_WIDTH states
+*with the fewest blockers at each level
+*
+*@return int the length of the solution found, -1 if the beam died out or got too deep
+*
+*@pre a loaded scenario
+*
+*@post scratch offsets and board hold some state of the scenario
+*
+**/
+int Solver::beamSearch(){
+    beamVisited.clear();
+    StateKey startKey = encode(puzzle);
+    beamVisited.insert(startKey);
+    vector<uint64_t> beam(1, rankOf(startKey));
+    vector<pair<int, uint64_t> > children;
+    for(int depth = 1; depth <= BEAM_MAX_DEPTH && !beam.empty(); depth++){
+        children.clear();
+        for(size_t f = 0; f < beam.size(); f++){
+            uint64_t rank = beam[f];
+            StateKey key = decode(rank);
+            for(int i = 0; i < numCars; i++){
+                StateKey step = StateKey(1) << (KEY_BITS * i);
+                if(slideForward(i)){
+                    if(beamVisited.insert(key + step)){
+                        if(i == 0 && complete()){
+                            return depth;
+                        }
+                        children.push_back(make_pair(blocking(), rank + weight[i]));
+                    }
+                    slideBackward(i);
+                }
+                if(slideBackward(i)){
+                    if(beamVisited.insert(key - step)){
+                        children.push_back(make_pair(blocking(), rank - weight[i]));
+                    }
+                    slideForward(i);
+                }
+            }
+        }
+        if(children.size() > BEAM_WIDTH){
+            nth_element(children.begin(), children.begin() + BEAM_WIDTH, children.end());
+            children.resize(BEAM_WIDTH);
+        }
+        beam.clear();
+        for(size_t c = 0; c < children.size(); c++){
+            beam.push_back(children[c].second);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,284 @@
+/** @file Solver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif library interface for solving rush hour with BFS
+@details Declares the vehicle struct, the move rules and a reusable Solver object. The
+Solver keeps its frontier, visited table and scratch arrays allocated between scenarios
+so a batch of puzzles does not pay for allocation and teardown on every solve. Inside a
+search a state is only the vehicles' lane offsets; lengths and lanes live in a VehicleTable.
+**/
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include<string>
+#include<vector>
+#include<thread>
+#include<atomic>
+#include<cstddef>
+#include<stdint.h>
+#include "HugePages.h"
+
+struct Vehicle{
+    int length;
+    char orientation;
+    int row;
+    int column;
+};
+
+//consts for array size, car and truck size, and horizontal check
+const int CAR = 2;
+const int TRUCK = 3;
+const char HORIZONTAL = 'H';
+const int MAX_VEHICLE = 18;
+const int MAX_ARR = 6;
+
+//a state packs every vehicle's offset in its lane into 3 bits (18 * 3 = 54 bits)
+typedef uint64_t StateKey;
+const int KEY_BITS = 3;
+
+void setBoard(int board[][MAX_ARR], const Vehicle& v, const int car);
+bool isCar(const Vehicle& v);
+void print(const int board[][MAX_ARR]);
+void fillArray(int board[][MAX_ARR]);
+bool moveForward(Vehicle& v, int board[][MAX_ARR]);
+bool moveBackward(Vehicle& v, int board[][MAX_ARR]);
+bool isComplete(const Vehicle& v, const int board[][MAX_ARR]);
+bool isHorizontal(const Vehicle& v);
+bool isCollisionForward(const Vehicle& v, const int board[][MAX_ARR]);
+bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]);
+bool isValidScenario(const Vehicle cars[], const int numCars);
+bool isProvenUnsolvable(const Vehicle cars[], const int numCars);
+int blockers(const Vehicle cars[], const int board[][MAX_ARR]);
+
+/**
+* VisitedTable open addressing set of state keys. Clearing only bumps a generation
+* stamp, so the slots stay allocated and warm between scenarios.
+**/
+class VisitedTable{
+public:
+    VisitedTable();
+    void clear();
+    bool insert(StateKey key);
+    void prefetch(StateKey key) const;
+    bool contains(StateKey key) const;
+    size_t size() const;
+    void list(std::vector<StateKey>& out) const;
+
+private:
+    size_t slotFor(StateKey key) const;
+    void grow();
+
+    std::vector<StateKey, HugePageAllocator<StateKey> > keys;
+    std::vector<uint32_t, HugePageAllocator<uint32_t> > stamps;
+    uint32_t generation;
+    size_t count;
+    size_t mask;
+    int shift;
+};
+
+/**
+* VisitedBitmap one bit per possible state, indexed by the state's mixed radix rank.
+* Words that were set are remembered so clear only touches them.
+**/
+class VisitedBitmap{
+public:
+    VisitedBitmap();
+    void resize(uint64_t numStates);
+    void clear();
+    bool insert(uint64_t rank);
+    void prefetch(uint64_t rank) const;
+    size_t size() const;
+    void list(std::vector<uint64_t>& out) const;
+
+private:
+    std::vector<uint64_t, HugePageAllocator<uint64_t> > bits;
+    std::vector<size_t, HugePageAllocator<size_t> > dirty;
+    size_t count;
+};
+
+//a block of ranks decoded from a FrontierBuffer
+typedef std::vector<uint64_t, HugePageAllocator<uint64_t> > RankBlock;
+
+/**
+* FrontierBuffer the states of one BFS level. Small levels stay as a plain vector; once a
+* level grows past FRONTIER_RUN values they are sorted in runs and stored as delta plus
+* variable length integers in blocks of FRONTIER_BLOCK values, which are decoded one
+* block at a time while the level is expanded. Once the level is complete finish merges
+* the runs into one sorted order, which divides the deltas by the number of runs: about
+* 1.5 bytes a state on wide levels against 3 for runs sorted alone.
+**/
+class FrontierBuffer{
+public:
+    FrontierBuffer();
+    void clear();
+    void push(uint64_t value);
+    void finish();
+    size_t size() const;
+    bool empty() const;
+    size_t bytes() const;
+    size_t blockCount() const;
+    void readBlock(size_t block, RankBlock& out) const;
+    void swap(FrontierBuffer& other);
+
+private:
+    void compressRun();
+
+    RankBlock staging;                 //values not yet compressed
+    std::vector<uint8_t, HugePageAllocator<uint8_t> > data;     //compressed blocks back to back
+    std::vector<size_t, HugePageAllocator<size_t> > blockStart;       //offset of each compressed block in data
+    std::vector<uint16_t, HugePageAllocator<uint16_t> > blockSize;    //number of values in each compressed block
+    size_t count;
+};
+
+const size_t FRONTIER_RUN = 1 << 12;
+const size_t FRONTIER_BLOCK = 256;
+
+//how the solver remembers visited states
+enum VisitedBackend{ VISITED_AUTO, VISITED_HASH, VISITED_DENSE };
+
+//largest rank spaces covered by a bitmap when automatic (16 MB) and when asked for (1 GB)
+const uint64_t DENSE_AUTO_STATES = 1ULL << 27;
+const uint64_t DENSE_MAX_STATES = 1ULL << 33;
+
+//how a budgeted solve ended: the exact answer, proof there is none, or only bounds
+enum SolveStatus{ SOLVE_EXACT, SOLVE_UNSOLVABLE, SOLVE_BOUNDED };
+
+struct SolveResult{
+    SolveStatus status;
+    int lower;      //proven minimum number of moves (the answer when exact)
+    int upper;      //length of a solution found, -1 if none was found
+};
+
+//children generated and prefetched before the visited set is probed for any of them
+const size_t PROBE_BATCH = 64;
+
+//beam kept per level by the search for an upper bound, and how deep it goes
+const size_t BEAM_WIDTH = 1024;
+const int BEAM_MAX_DEPTH = 512;
+
+/**
+* VehicleTable the parts of a scenario's vehicles that never change during a search, one
+* array per attribute. A vehicle's squares on the flat board are base + position * stride,
+* so a state only needs each vehicle's 1 byte offset along its lane.
+**/
+struct VehicleTable{
+    uint8_t length[MAX_VEHICLE];
+    uint8_t radix[MAX_VEHICLE];     //offsets the vehicle can take, MAX_ARR - length + 1
+    uint8_t base[MAX_VEHICLE];      //flat index of the vehicle's lane at position 0
+    uint8_t stride[MAX_VEHICLE];    //1 along a row, MAX_ARR along a column
+};
+
+/**
+* Checkpoint a BFS stopped at a level boundary: its scenario, the level reached and the
+* ranks of the frontier and visited states, enough to carry on as if never stopped.
+* On disk the rank lists are sorted and stored as delta plus variable length integers.
+**/
+struct Checkpoint{
+    int numCars;
+    Vehicle cars[MAX_VEHICLE];
+    int depth;                          //moves needed to reach every frontier state
+    std::vector<uint64_t> frontier;
+    std::vector<uint64_t> visited;      //includes the frontier
+};
+
+const char CHECKPOINT_MAGIC[8] = {'R', 'H', 'C', 'H', 'E', 'C', 'K', '1'};
+
+//seconds between checkpoints when none is given
+const double CHECKPOINT_SECONDS = 60;
+
+bool writeCheckpoint(const std::string& path, Checkpoint& checkpoint);
+bool readCheckpoint(const std::string& path, Checkpoint& checkpoint);
+
+/**
+* CheckpointWriter writes one checkpoint at a time on a background thread, so a search only
+* stops for as long as copying its state takes
+**/
+class CheckpointWriter{
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+    void write(const std::string& path, Checkpoint& checkpoint);
+    void wait();
+
+private:
+    CheckpointWriter(const CheckpointWriter&);
+    CheckpointWriter& operator=(const CheckpointWriter&);
+
+    std::thread worker;
+    std::string path;
+    Checkpoint pending;     //the checkpoint being written
+};
+
+/**
+* Solver reusable BFS solver. Construct once and call solve for every scenario; the
+* frontier, visited table and scratch board are reused rather than rebuilt.
+**/
+class Solver{
+public:
+    Solver();
+    void reset();
+    bool solve(const Vehicle cars[], const int numCars, int& moves);
+    size_t statesVisited() const;
+    void setVisitedBackend(VisitedBackend backend);
+    void setBudget(double seconds, uint64_t nodes);
+    void setProbeBatch(size_t children);
+    void setCancel(const std::atomic<bool>* cancel);
+    void setCheckpoint(const std::string& path, double seconds);
+    void setResume(const Checkpoint* checkpoint);
+    void setMemoryLimit(size_t bytes);
+    bool memoryCapped() const;
+    SolveResult solveBounded(const Vehicle cars[], const int numCars);
+
+private:
+    SolveStatus search(bool budgeted, int& depth);
+    int beamSearch();
+    void load(const Vehicle cars[], const int numCars);
+    StateKey encode(const Vehicle cars[]) const;
+    StateKey decode(uint64_t rank);
+    uint64_t rankOf(StateKey key) const;
+    bool markVisited(StateKey key, uint64_t rank);
+    void prefetchVisited(StateKey key, uint64_t rank) const;
+    void probeBatch();
+    bool slideForward(int i);
+    bool slideBackward(int i);
+    bool complete() const;
+    int blocking() const;
+    void release();
+    bool restore(int& depth);
+    void snapshot(int depth);
+
+    Vehicle puzzle[MAX_VEHICLE];    //vehicles as read for the current scenario
+    VehicleTable table;                   //static attributes of the scenario's vehicles
+    uint8_t offset[MAX_VEHICLE];          //scratch offsets of the state being expanded
+    uint8_t board[MAX_ARR * MAX_ARR];     //scratch board for the state being expanded, row major
+    int numCars;
+
+    FrontierBuffer frontier;          //ranks of the states at the current BFS level
+    FrontierBuffer next;              //ranks of the states at the following BFS level
+    RankBlock block;                  //scratch for the frontier block being expanded
+    std::vector<StateKey, HugePageAllocator<StateKey> > batchKeys;    //children waiting to be probed
+    RankBlock batchRanks;
+    size_t batchSize;                 //children gathered before a probe
+    VisitedTable visited;
+    VisitedBitmap bitmap;
+    VisitedBackend backend;
+    bool dense;                       //the current scenario uses the bitmap
+    uint64_t weight[MAX_VEHICLE];     //rank weight of one step of each vehicle
+
+    double budgetSeconds;             //time solveBounded may spend searching, 0 for no limit
+    uint64_t budgetNodes;             //states solveBounded may expand, 0 for no limit
+    VisitedTable beamVisited;         //states the beam search has reached
+    const std::atomic<bool>* cancel;  //set by another thread to stop the search, may be NULL
+
+    std::string checkpointPath;       //where level boundaries are saved, empty for never
+    double checkpointSeconds;         //least time between two checkpoints
+    const Checkpoint* resume;         //continued by the next solve of its scenario, may be NULL
+    Checkpoint saved;                 //scratch for the checkpoint being taken
+    CheckpointWriter writer;
+
+    size_t memoryLimit;               //bytes the solver's tables may take, 0 for no limit
+    bool capped;                      //the last solve stopped at the memory limit
+};
+
+#endif
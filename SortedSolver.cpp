@@ -0,0 +1,217 @@
+/** @file SortedSolver.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour BFS with sort based duplicate detection
+@details Ranks are sorted least significant digit first, skipping the digits every child
+shares, so a level of n children costs a few linear passes over 8n bytes.
+**/
+
+
+#include<algorithm>
+#include<cstring>
+#include "SortedSolver.h"
+
+using namespace std;
+
+/**
+* SortedSolver constructor
+*
+*@pre none
+*
+*@post a solver ready for its first scenario
+*
+**/
+SortedSolver::SortedSolver(){
+    numCars = 0;
+    rankBits = 0;
+    states = 0;
+    memset(board, 0, sizeof(board));
+}
+
+/**
+* statesVisited  method that reports how many states the last solve discovered
+*
+*@return size_t number of distinct states
+*
+**/
+size_t SortedSolver::statesVisited() const{
+    return states;
+}
+
+/**
+* load  method that builds the vehicle table and rank weights of a scenario
+*
+*@return void
+*
+*@param cars the vehicles as read in
+*
+*@param numCars number of vehicles
+*
+**/
+void SortedSolver::load(const Vehicle cars[], const int numCars){
+    this->numCars = numCars;
+    uint64_t numStates = 1;
+    for(int i = 0; i < numCars; i++){
+        table.length[i] = cars[i].length;
+        table.radix[i] = MAX_ARR - cars[i].length + 1;
+        table.base[i] = isHorizontal(cars[i]) ? cars[i].row * MAX_ARR : cars[i].column;
+        table.stride[i] = isHorizontal(cars[i]) ? 1 : MAX_ARR;
+        weight[i] = numStates;
+        numStates *= table.radix[i];
+    }
+    rankBits = 0;
+    while(rankBits < 64 && (numStates - 1) >> rankBits != 0){
+        rankBits++;
+    }
+}
+
+/**
+* place  method that unpacks a rank into the scratch offsets and board
+*
+*@return void
+*
+*@param rank the rank of a state of the current scenario
+*
+**/
+void SortedSolver::place(uint64_t rank){
+    memset(board, 0, sizeof(board));
+    for(int i = 0; i < numCars; i++){
+        int position = (int)(rank % table.radix[i]);
+        rank /= table.radix[i];
+        offset[i] = position;
+        for(int k = 0; k < table.length[i]; k++){
+            board[table.base[i] + (position + k) * table.stride[i]] = i + 1;
+        }
+    }
+}
+
+/**
+* sortChildren  method that radix sorts the children and drops repeats
+*
+*@return void
+*
+*@post children is sorted and unique
+*
+**/
+void SortedSolver::sortChildren(){
+    const size_t buckets = size_t(1) << SORT_DIGIT_BITS;
+    size_t count[buckets];
+    scratch.resize(children.size());
+    for(int shift = 0; shift < rankBits; shift += SORT_DIGIT_BITS){
+        memset(count, 0, sizeof(count));
+        for(size_t c = 0; c < children.size(); c++){
+            count[(children[c] >> shift) & (buckets - 1)]++;
+        }
+        //a digit every child shares leaves the order as it is
+        if(count[(children[0] >> shift) & (buckets - 1)] == children.size()){
+            continue;
+        }
+        size_t start = 0;
+        for(size_t b = 0; b < buckets; b++){
+            size_t size = count[b];
+            count[b] = start;
+            start += size;
+        }
+        for(size_t c = 0; c < children.size(); c++){
+            scratch[count[(children[c] >> shift) & (buckets - 1)]++] = children[c];
+        }
+        children.swap(scratch);
+    }
+    children.erase(unique(children.begin(), children.end()), children.end());
+}
+
+/**
+* subtractSeen  method that removes the current and previous levels from the children
+*
+*@return void
+*
+*@pre sorted, unique children, current and previous
+*
+*@post scratch holds the next level, sorted
+*
+**/
+void SortedSolver::subtractSeen(){
+    scratch.clear();
+    size_t c = 0;
+    size_t p = 0;
+    for(size_t n = 0; n < children.size(); n++){
+        uint64_t rank = children[n];
+        while(c < current.size() && current[c] < rank){
+            c++;
+        }
+        while(p < previous.size() && previous[p] < rank){
+            p++;
+        }
+        if((c == current.size() || current[c] != rank) && (p == previous.size() || previous[p] != rank)){
+            scratch.push_back(rank);
+        }
+    }
+}
+
+/**
+*solve  method that runs the level by level BFS, calculating the minimum possible moves
+*it requires to complete the game (if such moves exist)
+*
+*@return bool indicating whether or not the puzzle is solvable
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+*@param moves the minimum number of moves, set when the puzzle is solvable
+*
+*@pre vehicles that do not overlap
+*
+*@post the level buffers keep their capacity for the next scenario
+*
+**/
+bool SortedSolver::solve(const Vehicle cars[], const int numCars, int& moves){
+    load(cars, numCars);
+    previous.clear();
+    current.clear();
+    states = 1;
+    uint64_t start = 0;
+    for(int i = 0; i < numCars; i++){
+        start += (isHorizontal(cars[i]) ? cars[i].column : cars[i].row) * weight[i];
+    }
+    place(start);
+    if(offset[0] + table.length[0] == MAX_ARR){
+        moves = 0;
+        return true;
+    }
+    if(isProvenUnsolvable(cars, numCars)){
+        return false;
+    }
+    current.push_back(start);
+
+    for(int depth = 0; !current.empty(); depth++){
+        children.clear();
+        for(size_t f = 0; f < current.size(); f++){
+            uint64_t rank = current[f];
+            place(rank);
+            for(int i = 0; i < numCars; i++){
+                int end = offset[i] + table.length[i];
+                if(end < MAX_ARR && board[table.base[i] + end * table.stride[i]] == 0){
+                    //a goal is never in a level, since the search would have stopped there
+                    if(i == 0 && end + 1 == MAX_ARR){
+                        moves = depth + 1;
+                        return true;
+                    }
+                    children.push_back(rank + weight[i]);
+                }
+                if(offset[i] > 0 && board[table.base[i] + (offset[i] - 1) * table.stride[i]] == 0){
+                    children.push_back(rank - weight[i]);
+                }
+            }
+        }
+        if(children.empty()){
+            break;
+        }
+        sortChildren();
+        subtractSeen();
+        previous.swap(current);
+        current.swap(scratch);
+        states += current.size();
+    }
+    return false;
+}
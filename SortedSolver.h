@@ -0,0 +1,53 @@
+/** @file SortedSolver.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif rush hour BFS with sort based duplicate detection
+@details Keeps no visited set. Each level's children are gathered as ranks in one flat
+buffer, radix sorted, deduplicated, and merged against the current and previous levels
+to drop the states already seen. Every move can be undone, so a child of level d is at
+level d - 1, d or d + 1, and those two levels are all that has to be subtracted. Every
+pass reads and writes its buffers front to back, so the search streams through memory
+instead of probing a table at random once per child.
+**/
+
+#ifndef SORTED_SOLVER_H
+#define SORTED_SOLVER_H
+
+#include<vector>
+#include "Solver.h"
+
+//bits of a rank sorted per radix pass
+const int SORT_DIGIT_BITS = 8;
+
+/**
+* SortedSolver reusable delayed duplicate detection BFS; its level buffers stay allocated
+* between scenarios
+**/
+class SortedSolver{
+public:
+    SortedSolver();
+    bool solve(const Vehicle cars[], const int numCars, int& moves);
+    size_t statesVisited() const;
+
+private:
+    void load(const Vehicle cars[], const int numCars);
+    void place(uint64_t rank);
+    void sortChildren();
+    void subtractSeen();
+
+    VehicleTable table;
+    uint64_t weight[MAX_VEHICLE];     //rank weight of one step of each vehicle
+    uint8_t offset[MAX_VEHICLE];      //scratch offsets of the state being expanded
+    uint8_t board[MAX_ARR * MAX_ARR]; //scratch board for the state being expanded, row major
+    int numCars;
+    int rankBits;                     //bits needed by the largest rank of the scenario
+    size_t states;
+
+    typedef std::vector<uint64_t, HugePageAllocator<uint64_t> > Level;
+    Level previous;     //sorted ranks of the level before the current one
+    Level current;      //sorted ranks of the level being expanded
+    Level children;     //children of the current level, sorted and unique once gathered
+    Level scratch;      //second buffer for the radix sort and the merge
+};
+
+#endif
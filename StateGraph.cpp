@@ -0,0 +1,649 @@
+/** @file StateGraph.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif reachable state graph of a scenario for offline analysis
+@details Edges are never held in memory: they are regenerated from the move rules and
+streamed straight to the file, first to count them, then as row offsets and finally as the
+edges themselves. Peak memory is in the discovery BFS, whose VisitedTable keeps 12 bytes
+a slot at a load of at most 1/2 and briefly holds the old and new tables while it grows:
+up to about 72 bytes a state plus 8 to 16 for the key list. Once it is freed, the sorted
+keys (8), distances (2), the BFS queue (4) and the NodeIndex (8 to 16) take 22 to 30
+bytes a state, and writing the file needs all of them but the queue.
+**/
+
+
+#include<iostream>
+#include<fstream>
+#include<vector>
+#include<algorithm>
+#include<cstring>
+#include<unistd.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "StateGraph.h"
+
+using namespace std;
+
+/**
+* placeKey  method that moves a scenario's vehicles to the offsets of a key
+*
+*@return void
+*
+*@param key a packed state of the scenario
+*
+*@param cars the scenario's vehicles, moved to the state
+*
+*@param numCars number of vehicles
+*
+*@param board filled with the state
+*
+**/
+static void placeKey(StateKey key, Vehicle cars[], const int numCars, int board[][MAX_ARR]){
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        int offset = (int)((key >> (KEY_BITS * i)) & 7);
+        if(isHorizontal(cars[i])){
+            cars[i].column = offset;
+        }
+        else{
+            cars[i].row = offset;
+        }
+        setBoard(board, cars[i], i + 1);
+    }
+}
+
+/**
+* neighbors  method that lists the keys one move away from a state
+*
+*@return void
+*
+*@param key a packed state of the scenario
+*
+*@param cars scratch copy of the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param out set to the neighboring keys, in vehicle order with forward before backward
+*
+**/
+static void neighbors(StateKey key, Vehicle cars[], const int numCars, vector<StateKey>& out){
+    int board[MAX_ARR][MAX_ARR];
+    placeKey(key, cars, numCars, board);
+    out.clear();
+    for(int i = 0; i < numCars; i++){
+        StateKey step = StateKey(1) << (KEY_BITS * i);
+        if(moveForward(cars[i], board)){
+            out.push_back(key + step);
+            moveBackward(cars[i], board);
+        }
+        if(moveBackward(cars[i], board)){
+            out.push_back(key - step);
+            moveForward(cars[i], board);
+        }
+    }
+}
+
+/**
+* indexOf  method that binary searches a sorted key array
+*
+*@return int64_t the key's index, -1 if it is not there
+*
+**/
+static int64_t indexOf(const StateKey* keys, uint64_t count, StateKey key){
+    const StateKey* found = lower_bound(keys, keys + count, key);
+    if(found == keys + count || *found != key){
+        return -1;
+    }
+    return found - keys;
+}
+
+/**
+* NodeIndex hash from each key of a sorted key array to its node, so walking the moves
+* between states costs one probe per move rather than a binary search
+**/
+class NodeIndex{
+public:
+    NodeIndex(const vector<StateKey>& sorted) : keys(sorted){
+        int bits = 1;
+        while((size_t(1) << bits) < keys.size() * 2){
+            bits++;
+        }
+        slots.assign(size_t(1) << bits, 0);
+        mask = slots.size() - 1;
+        shift = 64 - bits;
+        for(size_t v = 0; v < keys.size(); v++){
+            size_t slot = slotFor(keys[v]);
+            while(slots[slot] != 0){
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = (uint32_t)v + 1;
+        }
+    }
+
+    //the key's node, -1 if it is not there
+    int64_t find(StateKey key) const{
+        for(size_t slot = slotFor(key); slots[slot] != 0; slot = (slot + 1) & mask){
+            if(keys[slots[slot] - 1] == key){
+                return slots[slot] - 1;
+            }
+        }
+        return -1;
+    }
+
+private:
+    size_t slotFor(StateKey key) const{
+        return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+
+    const vector<StateKey>& keys;
+    vector<uint32_t> slots;     //node + 1 in each used slot, 0 in free ones
+    size_t mask;
+    int shift;
+};
+
+/**
+* pad  method that pads a file to the next 8 byte boundary
+*
+*@return uint64_t the padded length
+*
+**/
+static uint64_t pad(ofstream& out, uint64_t length){
+    static const char zeros[8] = {0};
+    uint64_t padded = (length + 7) & ~(uint64_t)7;
+    out.write(zeros, padded - length);
+    return padded;
+}
+
+/**
+* discover  method that lists every state reachable from a scenario
+*
+*@return bool false if more than maxStates states are reachable, leaving keys unsorted
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param keys set to the reachable states, sorted
+*
+*@param maxStates most states to find, 0 for no limit
+*
+**/
+static bool discover(const Vehicle cars[], const int numCars, vector<StateKey>& keys, uint64_t maxStates){
+    Vehicle scratch[MAX_VEHICLE];
+    StateKey startKey = 0;
+    for(int i = 0; i < numCars; i++){
+        scratch[i] = cars[i];
+        startKey |= (StateKey)(isHorizontal(cars[i]) ? cars[i].column : cars[i].row) << (KEY_BITS * i);
+    }
+
+    //a BFS that uses the node list as its queue
+    keys.assign(1, startKey);
+    vector<StateKey> next;
+    VisitedTable visited;
+    visited.insert(startKey);
+    for(size_t f = 0; f < keys.size(); f++){
+        neighbors(keys[f], scratch, numCars, next);
+        for(size_t n = 0; n < next.size(); n++){
+            if(visited.insert(next[n])){
+                keys.push_back(next[n]);
+            }
+        }
+        if(maxStates != 0 && keys.size() > maxStates){
+            return false;
+        }
+    }
+    sort(keys.begin(), keys.end());
+    return true;
+}
+
+/**
+* goalDistances  method that finds each state's distance to the nearest goal by a BFS out
+* of every goal state, which works because moves are reversible
+*
+*@return void
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param keys every reachable state, sorted
+*
+*@param index the node of each key
+*
+*@param distances set to each state's distance, GRAPH_UNSOLVABLE if no goal is reachable
+*
+**/
+static void goalDistances(const Vehicle cars[], const int numCars, const vector<StateKey>& keys,
+                          const NodeIndex& index, vector<uint16_t>& distances){
+    Vehicle scratch[MAX_VEHICLE];
+    for(int i = 0; i < numCars; i++){
+        scratch[i] = cars[i];
+    }
+    uint64_t numNodes = keys.size();
+    distances.assign(numNodes, GRAPH_UNSOLVABLE);
+    vector<uint32_t> queue;
+    queue.reserve(numNodes);
+    vector<StateKey> next;
+    int board[MAX_ARR][MAX_ARR];
+    for(uint64_t v = 0; v < numNodes; v++){
+        placeKey(keys[v], scratch, numCars, board);
+        if(isComplete(scratch[0], board)){
+            distances[v] = 0;
+            queue.push_back((uint32_t)v);
+        }
+    }
+    for(size_t f = 0; f < queue.size(); f++){
+        uint32_t v = queue[f];
+        neighbors(keys[v], scratch, numCars, next);
+        for(size_t n = 0; n < next.size(); n++){
+            int64_t u = index.find(next[n]);
+            if(distances[u] == GRAPH_UNSOLVABLE){
+                distances[u] = distances[v] + 1;
+                queue.push_back((uint32_t)u);
+            }
+        }
+    }
+}
+
+/**
+* reachableDistances  method that finds every state reachable from a scenario and its
+* distance to the nearest goal
+*
+*@return bool false, with keys and distances meaningless, if more than maxStates states
+*are reachable
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param keys set to the reachable states, sorted
+*
+*@param distances set to each state's distance, GRAPH_UNSOLVABLE if no goal is reachable
+*
+*@param maxStates most states to enumerate, 0 for no limit
+*
+*@pre vehicles that do not overlap
+*
+**/
+bool reachableDistances(const Vehicle cars[], const int numCars, vector<StateKey>& keys, vector<uint16_t>& distances,
+                        uint64_t maxStates){
+    if(!discover(cars, numCars, keys, maxStates)){
+        return false;
+    }
+    NodeIndex index(keys);
+    goalDistances(cars, numCars, keys, index, distances);
+    return true;
+}
+
+/**
+* exportStateGraph  method that writes every state reachable from a scenario, its distance to
+* the goal and the moves between states to a file
+*
+*@return bool indicating the file was written
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param path file to write
+*
+*@pre vehicles that do not overlap
+*
+*@post a file StateGraph can map
+*
+**/
+bool exportStateGraph(const Vehicle cars[], const int numCars, const string& path){
+    Vehicle scratch[MAX_VEHICLE];
+    StateKey startKey = 0;
+    for(int i = 0; i < numCars; i++){
+        scratch[i] = cars[i];
+        startKey |= (StateKey)(isHorizontal(cars[i]) ? cars[i].column : cars[i].row) << (KEY_BITS * i);
+    }
+    vector<StateKey> keys;
+    vector<uint16_t> distances;
+    vector<StateKey> next;
+    discover(cars, numCars, keys, 0);
+    if(keys.size() >= 0xFFFFFFFFULL){
+        cerr << "state graph has " << keys.size() << " states, too many for 32 bit edges" << endl;
+        return false;
+    }
+    uint64_t numNodes = keys.size();
+    //one index serves the distances and the edges
+    NodeIndex index(keys);
+    goalDistances(cars, numCars, keys, index, distances);
+
+    uint64_t numEdges = 0;
+    for(uint64_t v = 0; v < numNodes; v++){
+        neighbors(keys[v], scratch, numCars, next);
+        numEdges += next.size();
+    }
+
+    GraphHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC));
+    header.numCars = numCars;
+    header.start = (uint32_t)indexOf(&keys[0], numNodes, startKey);
+    for(int i = 0; i < numCars; i++){
+        header.vehicles[i].length = cars[i].length;
+        header.vehicles[i].orientation = cars[i].orientation;
+        header.vehicles[i].lane = isHorizontal(cars[i]) ? cars[i].row : cars[i].column;
+    }
+    header.numNodes = numNodes;
+    header.numEdges = numEdges;
+    header.keysOffset = (sizeof(header) + 7) & ~(uint64_t)7;
+    header.distancesOffset = header.keysOffset + numNodes * sizeof(StateKey);
+    header.rowsOffset = (header.distancesOffset + numNodes * sizeof(uint16_t) + 7) & ~(uint64_t)7;
+    header.edgesOffset = header.rowsOffset + (numNodes + 1) * sizeof(uint64_t);
+
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    pad(out, sizeof(header));
+    out.write((const char*)&keys[0], numNodes * sizeof(StateKey));
+    out.write((const char*)&distances[0], numNodes * sizeof(uint16_t));
+    pad(out, header.distancesOffset + numNodes * sizeof(uint16_t));
+    uint64_t row = 0;
+    for(uint64_t v = 0; v < numNodes; v++){
+        out.write((const char*)&row, sizeof(row));
+        neighbors(keys[v], scratch, numCars, next);
+        row += next.size();
+    }
+    out.write((const char*)&row, sizeof(row));
+    for(uint64_t v = 0; v < numNodes; v++){
+        neighbors(keys[v], scratch, numCars, next);
+        for(size_t n = 0; n < next.size(); n++){
+            uint32_t u = (uint32_t)index.find(next[n]);
+            out.write((const char*)&u, sizeof(u));
+        }
+    }
+    return (bool)out;
+}
+
+/**
+* StateGraph constructor
+*
+*@pre none
+*
+*@post a graph with nothing mapped
+*
+**/
+StateGraph::StateGraph(){
+    mapping = NULL;
+    mappingSize = 0;
+    info = NULL;
+    keys = NULL;
+    distances = NULL;
+    rows = NULL;
+    edges = NULL;
+}
+
+/**
+* StateGraph destructor that unmaps the file
+**/
+StateGraph::~StateGraph(){
+    close();
+}
+
+/**
+* open  method that maps a state graph file read only
+*
+*@return bool indicating the file is a well formed state graph
+*
+*@param path the file written by exportStateGraph
+*
+*@pre none
+*
+*@post the graph is mapped and shared with every other process mapping the file
+*
+**/
+bool StateGraph::open(const string& path){
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return false;
+    }
+    struct stat status;
+    if(fstat(fd, &status) < 0 || (size_t)status.st_size < sizeof(GraphHeader)){
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED){
+        return false;
+    }
+    mapping = p;
+    mappingSize = status.st_size;
+    info = (const GraphHeader*)p;
+    //the sections must sit exactly where exportStateGraph puts them
+    uint64_t numNodes = info->numNodes;
+    uint64_t keysOffset = (sizeof(GraphHeader) + 7) & ~(uint64_t)7;
+    uint64_t distancesOffset = keysOffset + numNodes * sizeof(StateKey);
+    uint64_t rowsOffset = (distancesOffset + numNodes * sizeof(uint16_t) + 7) & ~(uint64_t)7;
+    uint64_t edgesOffset = rowsOffset + (numNodes + 1) * sizeof(uint64_t);
+    if(memcmp(info->magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC)) != 0 ||
+       info->numCars < 1 || info->numCars > (uint32_t)MAX_VEHICLE ||
+       numNodes == 0 || numNodes >= mappingSize || info->start >= numNodes ||
+       info->keysOffset != keysOffset || info->distancesOffset != distancesOffset ||
+       info->rowsOffset != rowsOffset || info->edgesOffset != edgesOffset ||
+       info->numEdges >= mappingSize ||
+       info->edgesOffset + info->numEdges * sizeof(uint32_t) != mappingSize){
+        close();
+        return false;
+    }
+    const char* base = (const char*)p;
+    keys = (const StateKey*)(base + info->keysOffset);
+    distances = (const uint16_t*)(base + info->distancesOffset);
+    rows = (const uint64_t*)(base + info->rowsOffset);
+    edges = (const uint32_t*)(base + info->edgesOffset);
+    return true;
+}
+
+/**
+* close  method that unmaps the file
+*
+*@return void
+*
+*@post nothing is mapped
+*
+**/
+void StateGraph::close(){
+    if(mapping != NULL){
+        munmap(mapping, mappingSize);
+    }
+    mapping = NULL;
+    mappingSize = 0;
+    info = NULL;
+    keys = NULL;
+    distances = NULL;
+    rows = NULL;
+    edges = NULL;
+}
+
+/**
+* header  method that returns the file's header, which describes the scenario's vehicles
+*
+*@return const GraphHeader& the header of an open graph
+*
+**/
+const GraphHeader& StateGraph::header() const{
+    return *info;
+}
+
+/**
+* numNodes  method that returns the number of reachable states
+*
+*@return uint64_t states in the graph
+*
+**/
+uint64_t StateGraph::numNodes() const{
+    return info->numNodes;
+}
+
+/**
+* numEdges  method that returns the number of moves between states, both directions counted
+*
+*@return uint64_t edges in the graph
+*
+**/
+uint64_t StateGraph::numEdges() const{
+    return info->numEdges;
+}
+
+/**
+* start  method that returns the node of the scenario as read
+*
+*@return uint64_t the starting node
+*
+**/
+uint64_t StateGraph::start() const{
+    return info->start;
+}
+
+/**
+* key  method that returns a node's packed state
+*
+*@return StateKey the state, KEY_BITS per vehicle
+*
+*@param node a node index
+*
+**/
+StateKey StateGraph::key(uint64_t node) const{
+    return keys[node];
+}
+
+/**
+* distance  method that returns a node's distance to the nearest goal
+*
+*@return int moves needed, GRAPH_UNSOLVABLE if the goal cannot be reached
+*
+*@param node a node index
+*
+**/
+int StateGraph::distance(uint64_t node) const{
+    return distances[node];
+}
+
+/**
+* edgesBegin  method that returns the first neighbor of a node
+*
+*@return const uint32_t* start of the node's edges
+*
+*@param node a node index
+*
+**/
+const uint32_t* StateGraph::edgesBegin(uint64_t node) const{
+    return edges + rows[node];
+}
+
+/**
+* edgesEnd  method that returns one past the last neighbor of a node
+*
+*@return const uint32_t* end of the node's edges
+*
+*@param node a node index
+*
+**/
+const uint32_t* StateGraph::edgesEnd(uint64_t node) const{
+    return edges + rows[node + 1];
+}
+
+/**
+* find  method that looks up the node of a packed state
+*
+*@return int64_t the node index, -1 if the state is not reachable
+*
+*@param key a packed state of the scenario
+*
+**/
+int64_t StateGraph::find(StateKey key) const{
+    return indexOf(keys, info->numNodes, key);
+}
+
+/**
+* checkStateGraph  method that maps an exported graph and checks it against a fresh BFS of
+* the scenario recorded in its header: the same states and distances, each node's edges
+* leading to the states one move away, and the start's distance matching Solver's answer
+*
+*@return bool indicating the file agrees with the BFS, mismatches are reported on cerr
+*
+*@param path file written by exportStateGraph
+*
+*@param numNodes set to the graph's node count
+*
+*@param numEdges set to the graph's edge count
+*
+**/
+bool checkStateGraph(const string& path, uint64_t& numNodes, uint64_t& numEdges){
+    StateGraph graph;
+    if(!graph.open(path)){
+        cerr << path << " is not a state graph" << endl;
+        return false;
+    }
+    numNodes = graph.numNodes();
+    numEdges = graph.numEdges();
+    const GraphHeader& header = graph.header();
+    int numCars = header.numCars;
+    Vehicle cars[MAX_VEHICLE];
+    StateKey startKey = graph.key(graph.start());
+    for(int i = 0; i < numCars; i++){
+        int offset = (int)((startKey >> (KEY_BITS * i)) & 7);
+        cars[i].length = header.vehicles[i].length;
+        cars[i].orientation = header.vehicles[i].orientation;
+        cars[i].row = isHorizontal(cars[i]) ? header.vehicles[i].lane : offset;
+        cars[i].column = isHorizontal(cars[i]) ? offset : header.vehicles[i].lane;
+    }
+    if(!isValidScenario(cars, numCars)){
+        cerr << "the start node is not a valid scenario" << endl;
+        return false;
+    }
+
+    vector<StateKey> keys;
+    vector<uint16_t> distances;
+    reachableDistances(cars, numCars, keys, distances, 0);
+    if(keys.size() != numNodes){
+        cerr << "the graph has " << numNodes << " nodes, the BFS reaches " << keys.size() << endl;
+        return false;
+    }
+    Vehicle scratch[MAX_VEHICLE];
+    for(int i = 0; i < numCars; i++){
+        scratch[i] = cars[i];
+    }
+    vector<StateKey> next;
+    uint64_t counted = 0;
+    for(uint64_t v = 0; v < numNodes; v++){
+        if(graph.key(v) != keys[v] || graph.distance(v) != distances[v]){
+            cerr << "node " << v << " differs from the BFS" << endl;
+            return false;
+        }
+        neighbors(keys[v], scratch, numCars, next);
+        const uint32_t* begin = graph.edgesBegin(v);
+        const uint32_t* end = graph.edgesEnd(v);
+        if(end < begin || (size_t)(end - begin) != next.size() || counted + next.size() > numEdges){
+            cerr << "node " << v << " has " << (end - begin) << " edges, " << next.size() << " moves" << endl;
+            return false;
+        }
+        for(size_t n = 0; n < next.size(); n++){
+            if(begin[n] >= numNodes || keys[begin[n]] != next[n]){
+                cerr << "edge " << n << " of node " << v << " does not lead one move away" << endl;
+                return false;
+            }
+        }
+        counted += next.size();
+    }
+    if(counted != numEdges){
+        cerr << "the graph has " << numEdges << " edges, the moves give " << counted << endl;
+        return false;
+    }
+
+    Solver solver;
+    int moves = 0;
+    bool solvable = solver.solve(cars, numCars, moves);
+    int distance = graph.distance(graph.start());
+    if(solvable != (distance != GRAPH_UNSOLVABLE) || (solvable && moves != distance)){
+        cerr << "the start is " << distance << " moves from the goal in the graph, Solver says "
+             << (solvable ? moves : -1) << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/** @file StateGraph.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif reachable state graph of a scenario for offline analysis
+@details exportStateGraph enumerates every state reachable from a scenario with the usual
+move rules, finds each state's distance to the nearest goal and writes the graph in
+compressed sparse row form. StateGraph maps such a file read only so analyses can walk
+it in one linear pass instead of searching again, and checkStateGraph reads one back
+through it to compare it with a fresh BFS.
+
+File layout, every section 8 byte aligned at the offset recorded in the GraphHeader:
+  keys      - uint64 packed state key of each node, sorted so a key can be binary searched
+  distances - uint16 moves from each node to the nearest goal, GRAPH_UNSOLVABLE if none
+  rows      - uint64 numNodes + 1 offsets, node i's edges are edges[rows[i]..rows[i + 1])
+  edges     - uint32 node index at the other end of each move
+Moves can always be undone, so every edge appears once in each direction.
+**/
+
+#ifndef STATE_GRAPH_H
+#define STATE_GRAPH_H
+
+#include<string>
+#include<vector>
+#include<cstddef>
+#include<stdint.h>
+#include "Solver.h"
+
+const char GRAPH_MAGIC[8] = {'R', 'H', 'G', 'R', 'A', 'P', 'H', '1'};
+const uint16_t GRAPH_UNSOLVABLE = 0xFFFF;
+
+struct GraphVehicle{
+    uint8_t length;
+    char orientation;
+    uint8_t lane;       //the row of a horizontal vehicle, the column of a vertical one
+    uint8_t unused;
+};
+
+struct GraphHeader{
+    char magic[8];
+    uint32_t numCars;
+    uint32_t start;     //node of the scenario as read
+    GraphVehicle vehicles[MAX_VEHICLE];
+    uint64_t numNodes;
+    uint64_t numEdges;
+    uint64_t keysOffset;
+    uint64_t distancesOffset;
+    uint64_t rowsOffset;
+    uint64_t edgesOffset;
+};
+
+/**
+* StateGraph read only view of a memory mapped state graph file
+**/
+class StateGraph{
+public:
+    StateGraph();
+    ~StateGraph();
+    bool open(const std::string& path);
+    void close();
+    const GraphHeader& header() const;
+    uint64_t numNodes() const;
+    uint64_t numEdges() const;
+    uint64_t start() const;
+    StateKey key(uint64_t node) const;
+    int distance(uint64_t node) const;
+    const uint32_t* edgesBegin(uint64_t node) const;
+    const uint32_t* edgesEnd(uint64_t node) const;
+    int64_t find(StateKey key) const;
+
+private:
+    StateGraph(const StateGraph&);
+    StateGraph& operator=(const StateGraph&);
+
+    void* mapping;
+    size_t mappingSize;
+    const GraphHeader* info;
+    const StateKey* keys;
+    const uint16_t* distances;
+    const uint64_t* rows;
+    const uint32_t* edges;
+};
+
+bool reachableDistances(const Vehicle cars[], const int numCars, std::vector<StateKey>& keys, std::vector<uint16_t>& distances,
+                        uint64_t maxStates);
+bool exportStateGraph(const Vehicle cars[], const int numCars, const std::string& path);
+bool checkStateGraph(const std::string& path, uint64_t& numNodes, uint64_t& numEdges);
+
+#endif
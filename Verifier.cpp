@@ -0,0 +1,391 @@
+/** @file Verifier.cpp
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif checks rush hour solutions claimed by other solvers
+@details The occupancy mask has bit row * MAX_ARR + column set for every covered square, so
+a slide only tests the square the vehicle enters and flips two bits. Input is parsed
+straight out of a read buffer rather than through iostreams, which would otherwise cost
+more than the replay itself.
+**/
+
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<thread>
+#include<cctype>
+#include<cstdlib>
+#include<climits>
+#include "Verifier.h"
+
+using namespace std;
+
+//longest move list accepted, so a corrupt count cannot exhaust memory
+const int VERIFY_MAX_MOVES = 1 << 24;
+
+/**
+* ClaimReader parses claims out of a stream in batches
+**/
+class ClaimReader{
+public:
+    ClaimReader(FILE* in) : in(in), pos(0), end(0), done(false), bad(false){
+        buffer.resize(1 << 20);
+    }
+
+    //fills the front of batch and returns how many claims were read, 0 at the end
+    size_t readBatch(vector<Claim>& batch){
+        size_t count = 0;
+        while(!done && count < batch.size()){
+            int numCars = 0;
+            if(!nextInt(numCars)){
+                //the input may end without the 0 scenario
+                done = true;
+                break;
+            }
+            if(numCars == 0){
+                done = true;
+                break;
+            }
+            Claim& claim = batch[count];
+            if(!readClaim(numCars, claim)){
+                done = true;
+                bad = true;
+                break;
+            }
+            count++;
+        }
+        return count;
+    }
+
+    //whether reading stopped at a claim that could not be parsed
+    bool malformed() const{
+        return bad;
+    }
+
+private:
+    bool readClaim(int numCars, Claim& claim){
+        if(numCars < 0 || numCars > MAX_VEHICLE){
+            return false;
+        }
+        claim.numCars = numCars;
+        for(int i = 0; i < numCars; i++){
+            Vehicle& v = claim.cars[i];
+            if(!nextInt(v.length) || !nextChar(v.orientation) || !nextInt(v.row) || !nextInt(v.column)){
+                return false;
+            }
+        }
+        int numMoves = 0;
+        if(!nextInt(numMoves) || numMoves < 0 || numMoves > VERIFY_MAX_MOVES){
+            return false;
+        }
+        claim.moves.resize(numMoves);
+        for(int m = 0; m < numMoves; m++){
+            if(!nextInt(claim.moves[m].vehicle) || !nextInt(claim.moves[m].delta)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool refill(){
+        pos = 0;
+        end = fread(&buffer[0], 1, buffer.size(), in);
+        return end > 0;
+    }
+
+    bool skipSpace(){
+        while(true){
+            if(pos == end && !refill()){
+                return false;
+            }
+            if(!isspace((unsigned char)buffer[pos])){
+                return true;
+            }
+            pos++;
+        }
+    }
+
+    bool nextChar(char& value){
+        if(!skipSpace()){
+            return false;
+        }
+        value = buffer[pos++];
+        return true;
+    }
+
+    bool nextInt(int& value){
+        if(!skipSpace()){
+            return false;
+        }
+        bool negative = buffer[pos] == '-';
+        if(negative || buffer[pos] == '+'){
+            pos++;
+        }
+        long parsed = 0;
+        int digits = 0;
+        while((pos < end || refill()) && isdigit((unsigned char)buffer[pos])){
+            //longer numbers are clamped rather than overflowing
+            if(parsed < INT_MAX / 10){
+                parsed = parsed * 10 + (buffer[pos] - '0');
+            }
+            pos++;
+            digits++;
+        }
+        value = (int)(negative ? -parsed : parsed);
+        return digits > 0;
+    }
+
+    FILE* in;
+    vector<char> buffer;
+    size_t pos;
+    size_t end;
+    bool done;      //the 0 scenario, the end of the stream or a parse error was reached
+    bool bad;
+};
+
+/**
+* replay  method that plays a move list on a scenario
+*
+*@return VerifyResult valid if every move is legal and the first car ends at the exit
+*
+*@param cars the scenario's vehicles
+*
+*@param numCars number of vehicles
+*
+*@param moves the claimed moves
+*
+*@param count number of moves
+*
+*@pre none, the scenario and moves are checked
+*
+**/
+VerifyResult replay(const Vehicle cars[], const int numCars, const Move moves[], const size_t count){
+    VerifyResult result = {VERIFY_VALID, 0, 0, -1};
+    if(!isValidScenario(cars, numCars)){
+        result.status = VERIFY_BAD_SCENARIO;
+        return result;
+    }
+    //a vehicle covers squares base + (offset + j) * stride for j below its length
+    int base[MAX_VEHICLE];
+    int stride[MAX_VEHICLE];
+    int offset[MAX_VEHICLE];
+    uint64_t occupied = 0;
+    for(int i = 0; i < numCars; i++){
+        base[i] = isHorizontal(cars[i]) ? cars[i].row * MAX_ARR : cars[i].column;
+        stride[i] = isHorizontal(cars[i]) ? 1 : MAX_ARR;
+        offset[i] = isHorizontal(cars[i]) ? cars[i].column : cars[i].row;
+        for(int j = 0; j < cars[i].length; j++){
+            occupied |= 1ULL << (base[i] + (offset[i] + j) * stride[i]);
+        }
+    }
+
+    for(size_t m = 0; m < count; m++){
+        int i = moves[m].vehicle;
+        int delta = moves[m].delta;
+        result.at = (int)m + 1;
+        if(i < 0 || i >= numCars || delta == 0){
+            result.status = VERIFY_BAD_MOVE;
+            return result;
+        }
+        int length = cars[i].length;
+        for(; delta > 0; delta--){
+            int ahead = offset[i] + length;
+            uint64_t enter = 1ULL << (base[i] + ahead * stride[i]);
+            if(ahead >= MAX_ARR || (occupied & enter) != 0){
+                result.status = VERIFY_BLOCKED;
+                return result;
+            }
+            occupied ^= enter | 1ULL << (base[i] + offset[i] * stride[i]);
+            offset[i]++;
+            result.moves++;
+        }
+        for(; delta < 0; delta++){
+            if(offset[i] == 0 || (occupied & 1ULL << (base[i] + (offset[i] - 1) * stride[i])) != 0){
+                result.status = VERIFY_BLOCKED;
+                return result;
+            }
+            uint64_t enter = 1ULL << (base[i] + (offset[i] - 1) * stride[i]);
+            occupied ^= enter | 1ULL << (base[i] + (offset[i] + length - 1) * stride[i]);
+            offset[i]--;
+            result.moves++;
+        }
+    }
+    result.at = 0;
+
+    //the end position goes through the usual goal test
+    Vehicle last[MAX_VEHICLE];
+    int board[MAX_ARR][MAX_ARR];
+    fillArray(board);
+    for(int i = 0; i < numCars; i++){
+        last[i] = cars[i];
+        if(isHorizontal(last[i])){
+            last[i].column = offset[i];
+        }
+        else{
+            last[i].row = offset[i];
+        }
+        setBoard(board, last[i], i + 1);
+    }
+    if(!isComplete(last[0], board)){
+        result.status = VERIFY_INCOMPLETE;
+    }
+    return result;
+}
+
+/**
+* Verifier constructor
+*
+*@pre none
+*
+*@post a verifier that only checks legality
+*
+**/
+Verifier::Verifier(){
+    optimal = false;
+}
+
+/**
+* setOptimality  method that turns the optimality check on or off
+*
+*@return void
+*
+*@param check whether valid claims must also use the fewest moves
+*
+**/
+void Verifier::setOptimality(bool check){
+    optimal = check;
+}
+
+/**
+* verify  method that checks one claim
+*
+*@return VerifyResult the outcome, with the optimum when optimality is checked
+*
+*@param claim a scenario and its claimed moves
+*
+**/
+VerifyResult Verifier::verify(const Claim& claim){
+    VerifyResult result = replay(claim.cars, claim.numCars, claim.moves.data(), claim.moves.size());
+    if(!optimal || result.status != VERIFY_VALID){
+        return result;
+    }
+    string key;
+    for(int i = 0; i < claim.numCars; i++){
+        key.push_back((char)claim.cars[i].length);
+        key.push_back(claim.cars[i].orientation);
+        key.push_back((char)claim.cars[i].row);
+        key.push_back((char)claim.cars[i].column);
+    }
+    unordered_map<string, int>::const_iterator found = optimum.find(key);
+    if(found == optimum.end()){
+        int moves = 0;
+        bool solved = solver.solve(claim.cars, claim.numCars, moves);
+        found = optimum.insert(make_pair(key, solved ? moves : -1)).first;
+    }
+    result.optimum = found->second;
+    if(result.moves > result.optimum){
+        result.status = VERIFY_NOT_OPTIMAL;
+    }
+    return result;
+}
+
+/**
+* describe  method that formats one claim's outcome
+*
+*@return void
+*
+*@param counter the claim's number in the input
+*
+*@param result its outcome
+*
+*@param optimal whether optimality was checked
+*
+*@param out text the line is appended to
+*
+**/
+static void describe(uint64_t counter, const VerifyResult& result, bool optimal, string& out){
+    out += "Solution " + to_string(counter);
+    switch(result.status){
+        case VERIFY_VALID:
+            out += (optimal ? " is optimal with " : " is valid with ") + to_string(result.moves) + " moves";
+            break;
+        case VERIFY_NOT_OPTIMAL:
+            out += " is not optimal: " + to_string(result.moves) + " moves, the scenario requires " + to_string(result.optimum);
+            break;
+        case VERIFY_BAD_SCENARIO:
+            out += " is invalid: the scenario is not valid";
+            break;
+        case VERIFY_BAD_MOVE:
+            out += " is invalid: move " + to_string(result.at) + " does not slide a vehicle";
+            break;
+        case VERIFY_BLOCKED:
+            out += " is invalid: move " + to_string(result.at) + " is blocked";
+            break;
+        case VERIFY_INCOMPLETE:
+            out += " is invalid: the first car does not reach the exit";
+            break;
+    }
+    out += '\n';
+}
+
+/**
+* verifyStream  method that verifies every claim in a stream and prints one line per claim
+*
+*@return int 0 if the whole stream was read, 1 if a claim could not be parsed
+*
+*@param in stream of claims, see Verifier.h
+*
+*@param numWorkers number of verifying threads, 0 picks one per core
+*
+*@param optimal whether valid claims must also use the fewest moves
+*
+**/
+int verifyStream(FILE* in, int numWorkers, bool optimal){
+    if(numWorkers <= 0){
+        numWorkers = (int)thread::hardware_concurrency();
+        if(numWorkers <= 0){
+            numWorkers = 1;
+        }
+    }
+    vector<Verifier> verifiers(numWorkers);
+    for(int w = 0; w < numWorkers; w++){
+        verifiers[w].setOptimality(optimal);
+    }
+
+    ClaimReader reader(in);
+    vector<Claim> current(VERIFY_BATCH);
+    vector<Claim> upcoming(VERIFY_BATCH);
+    vector<VerifyResult> results(VERIFY_BATCH);
+    size_t count = reader.readBatch(current);
+    uint64_t counter = 1;
+    string out;
+    while(count > 0){
+        //the workers verify this batch while the next one is parsed
+        vector<thread> threads;
+        for(int w = 0; w < numWorkers; w++){
+            threads.push_back(thread([&, w](){
+                for(size_t c = w; c < count; c += numWorkers){
+                    results[c] = verifiers[w].verify(current[c]);
+                }
+            }));
+        }
+        size_t following = reader.readBatch(upcoming);
+        for(size_t t = 0; t < threads.size(); t++){
+            threads[t].join();
+        }
+
+        out.clear();
+        for(size_t c = 0; c < count; c++){
+            describe(counter++, results[c], optimal, out);
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        current.swap(upcoming);
+        count = following;
+    }
+    fflush(stdout);
+    if(reader.malformed()){
+        cerr << "solution " << counter << " could not be parsed" << endl;
+        return 1;
+    }
+    return 0;
+}
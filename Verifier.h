@@ -0,0 +1,70 @@
+/** @file Verifier.h
+ @author Aaron Mcanerney, Justin Gill, Dylan Simard
+@version Revision 1.1
+@breif checks rush hour solutions claimed by other solvers
+@details Reads claims from a stream, each a scenario in the stdin format followed by its
+move list:
+  numMoves
+  vehicle delta     - one line per move: the vehicle's index in the scenario and how many
+                      squares it slides, positive toward a higher row or column
+A scenario with 0 vehicles ends the input. A move of delta squares counts as delta moves,
+the same as the solvers count them. Moves are replayed on a 36 bit occupancy mask with no
+allocation, and the final position must satisfy isComplete. Claims are verified in batches
+spread over worker threads while the next batch is parsed, and reported in input order.
+**/
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include<string>
+#include<vector>
+#include<cstdio>
+#include<unordered_map>
+#include "Solver.h"
+
+struct Move{
+    int vehicle;
+    int delta;
+};
+
+struct Claim{
+    int numCars;
+    Vehicle cars[MAX_VEHICLE];
+    std::vector<Move> moves;
+};
+
+//why a claim was accepted or rejected
+enum VerifyStatus{ VERIFY_VALID, VERIFY_NOT_OPTIMAL, VERIFY_BAD_SCENARIO, VERIFY_BAD_MOVE,
+                   VERIFY_BLOCKED, VERIFY_INCOMPLETE };
+
+struct VerifyResult{
+    VerifyStatus status;
+    int moves;      //squares slid by the whole list
+    int at;         //1 based index of the move that failed, 0 if none did
+    int optimum;    //fewest moves the scenario needs, -1 unless optimality was checked
+};
+
+//claims parsed and verified together
+const size_t VERIFY_BATCH = 1 << 14;
+
+VerifyResult replay(const Vehicle cars[], const int numCars, const Move moves[], const size_t count);
+
+/**
+* Verifier reusable claim checker. Optimality is checked with its own warm Solver and the
+* answer for each scenario is remembered, since many claims share a scenario.
+**/
+class Verifier{
+public:
+    Verifier();
+    void setOptimality(bool check);
+    VerifyResult verify(const Claim& claim);
+
+private:
+    Solver solver;
+    std::unordered_map<std::string, int> optimum;   //fewest moves per scenario, -1 if unsolvable
+    bool optimal;
+};
+
+int verifyStream(FILE* in, int numWorkers, bool optimal);
+
+#endif
@@ -3,12 +3,29 @@
 @version Revision 1.0
 @breif solves the rush hour game using DFS
 @details Uses DFS to solve the rush hour puzzle game. uses a struct to hold vehicles
-and does everything else with pass by reference methods. 
+and does everything else with pass by reference methods. The top levels of the search
+tree are split into tasks that a pool of threads share through work stealing deques,
+and every thread prunes against one atomic best score. A fixed size transposition table
+shared by the threads remembers the shallowest depth each board was reached at, so
+boards reached again at an equal or greater depth are not searched twice.
+With --deepen the same in place recursion runs as iterative deepening, raising the bound
+one step at a time, and --ida adds the blocker heuristic. Both keep memory proportional
+to the solution depth (plus the fixed size table unless --no-table is given).
 @date 10/3/2017
 **/
 
 
 #include<iostream>
+#include<string>
+#include<climits>
+#include<cstdlib>
+#include<deque>
+#include<vector>
+#include<mutex>
+#include<thread>
+#include<atomic>
+#include<memory>
+#include<stdint.h>
 #include <unistd.h>
 
 using namespace std;
@@ -26,6 +43,49 @@ const int TRUCK = 3;
 const char HORIZONTAL = 'H';
 const int MAX_ARR = 6;
 const int MAX_VEHICLE = 10;
+//moves below this depth are handed out as tasks, deeper ones are searched in place
+const int SPLIT_DEPTH = 3;
+
+//2^TABLE_BITS entries of 8 bytes (8 MB), however long the search runs
+const int TABLE_BITS = 20;
+const int BUCKET = 4;
+
+//each entry packs (board key + 1) in the high half and the depth in the low half, 0 is empty
+struct TranspositionTable{
+    TranspositionTable() : entries(new atomic<uint64_t>[1 << TABLE_BITS]){
+        for(int i = 0; i < (1 << TABLE_BITS); i++){
+            entries[i] = 0;
+        }
+    }
+    unique_ptr<atomic<uint64_t>[]> entries;
+};
+
+//what visit did with a board: already reached no deeper, recorded, or not kept because
+//a racing thread or a shallower entry won the slot (or the board pushed another one out)
+enum VisitResult{ VISIT_SEEN, VISIT_STORED, VISIT_LOST };
+
+struct Task{
+    Vehicle cars[MAX_VEHICLE];
+    int board[MAX_ARR][MAX_ARR];
+    int numMoves;
+};
+
+//one per thread; the owner pops from the back and idle threads steal from the front
+struct WorkDeque{
+    mutex lock;
+    deque<Task> tasks;
+};
+
+struct Pool{
+    Pool(int numThreads) : deques(numThreads){
+        pending = 0;
+    }
+    vector<WorkDeque> deques;
+    atomic<int> pending;    //tasks queued or running
+    atomic<int> best;
+    int numCars;
+    TranspositionTable table;
+};
 
 void read(int board[][MAX_ARR], int& numCars, Vehicle cars[]);
 void setBoard(int board[][MAX_ARR], const Vehicle& v, const int car);
@@ -36,7 +96,20 @@ bool moveForward(Vehicle& v, int board[][MAX_ARR]);
 bool moveBackward(Vehicle& v, int board[][MAX_ARR]);
 bool isComplete(const Vehicle& v, const int board[][MAX_ARR]);
 bool isHorizontal(const Vehicle& v);
-void solve(int numMoves, Vehicle cars[], int board[][MAX_ARR], int& best,const int& numCars, bool& result);
+void solve(int numMoves, Vehicle cars[], int board[][MAX_ARR], atomic<int>& best,const int& numCars, TranspositionTable& table);
+uint32_t boardKey(const Vehicle cars[], const int& numCars);
+VisitResult visit(TranspositionTable& table, const uint32_t key, const int depth);
+void improve(atomic<int>& best, const int numMoves);
+void pushTask(Pool& pool, const int id, const Task& task);
+bool takeTask(Pool& pool, const int id, Task& task);
+void runTask(Pool& pool, const int id, Task& task);
+void work(Pool& pool, const int id);
+void solveParallel(Vehicle cars[], int board[][MAX_ARR], atomic<int>& best, const int& numCars, const int numThreads);
+void clearTable(TranspositionTable& table);
+int blockers(const Vehicle cars[], const int board[][MAX_ARR]);
+bool deepen(int numMoves, Vehicle cars[], int board[][MAX_ARR], const int bound, const int& numCars, const int lastMove, const bool heuristic, TranspositionTable* table, int& nextBound, int& lost, int& moves);
+bool unresolved(const TranspositionTable& table, const int bound);
+bool solveDeepening(Vehicle cars[], int board[][MAX_ARR], const int& numCars, const bool heuristic, const bool useTable, const int maxDepth, int& moves);
 bool isCollisionForward(const Vehicle& v, const int board[][MAX_ARR]);
 bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]);
 
@@ -45,27 +118,74 @@ bool isCollisionBackward(const Vehicle& v, const int board[][MAX_ARR]);
 *
 *@return int indicating success
 *
+*@param argc number of command line arguments
+*
+*@param argv optional number of threads (one per core by default), --deepen or --ida for
+*iterative deepening, --no-table to drop the transposition table while deepening (which
+*needs --max) and --max n to stop at solutions of n moves
+*
 *@pre unsolved rush hour
 *
 *@post solved rush hour
 *
 *
 **/
-int main(){
+int main(int argc, char* argv[]){
     int board[MAX_ARR][MAX_ARR];
     Vehicle cars[MAX_VEHICLE];
     int numCars;
+    int numThreads = (int)thread::hardware_concurrency();
+    bool deepening = false;
+    bool heuristic = false;
+    bool useTable = true;
+    int maxDepth = -1;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--deepen"){
+            deepening = true;
+        }
+        else if(arg == "--ida"){
+            deepening = true;
+            heuristic = true;
+        }
+        else if(arg == "--no-table"){
+            useTable = false;
+        }
+        else if(arg == "--max" && i + 1 < argc){
+            maxDepth = atoi(argv[++i]);
+        }
+        else{
+            numThreads = atoi(argv[i]);
+        }
+    }
+    if(numThreads < 1){
+        numThreads = 1;
+    }
+    //without the table nothing can prove a puzzle unsolvable, so deepening would never stop
+    if(deepening && !useTable && maxDepth < 0){
+        cerr << "--no-table needs --max n to stop at" << endl;
+        return 1;
+    }
 
     fillArray(board);
     read(board, numCars, cars);
     int moves = 0;
-    int best = 11;
     bool result = false;
-
-    
-    solve(moves, cars,board,best, numCars, result);
+    if(deepening){
+        result = solveDeepening(cars, board, numCars, heuristic, useTable, maxDepth < 0 ? INT_MAX - 1 : maxDepth, moves);
+    }
+    else{
+        const int bound = maxDepth < 0 ? 11 : maxDepth + 1;
+        atomic<int> best(bound);
+        solveParallel(cars, board, best, numCars, numThreads);
+        result = best < bound;
+        moves = best;
+    }
     if(result){
-        cout << "Scenario 1" << " requires " << best << " moves"<<endl;
+        cout << "Scenario 1" << " requires " << moves << " moves"<<endl;
+    }
+    else if(maxDepth >= 0){
+        cout << "No solution within " << maxDepth << " moves" << endl;
     }
     else{
         cout << "Cant be solved "<< endl;
@@ -488,39 +608,35 @@ bool isComplete(const Vehicle& v, const int board[][MAX_ARR]){
 *
 *@param numMoves the number of moves currently used
 *
-*@param best the best score thus far
-*
-*@param result indicates whether or not the puzzle is solvable
+*@param best the best score thus far, shared by every thread
 *
 *@param numCars number of cars currently on the board
 *
+*@param table boards already searched and the shallowest depth they were reached at
+*
 *@pre vehicle v, 2d board
 *
-*@post a boolean value indicating if the car was moved. A car in a new position on the board.
+*@post best is lowered if a shorter solution was found below this board
 *
 **/
 
-void solve(int numMoves, Vehicle cars[], int board[][MAX_ARR], int& best, const int& numCars, bool& result){
-    if(isComplete(cars[0], board) || numMoves > best){
-        if(numMoves < best){
-            best = numMoves;
-            result = true;
-            return;
-        }
-        else{
-            return;
-        }
-        //return;
+void solve(int numMoves, Vehicle cars[], int board[][MAX_ARR], atomic<int>& best, const int& numCars, TranspositionTable& table){
+    if(isComplete(cars[0], board) || numMoves > best.load(memory_order_relaxed)){
+        improve(best, numMoves);
+        return;
+    }
+    else if(visit(table, boardKey(cars, numCars), numMoves) == VISIT_SEEN){
+        return;
     }
     else{ 
         for(int i = 0; i < numCars; i++){
             if(moveForward(cars[i], board)){
-                solve(numMoves + 1, cars, board, best, numCars, result);
+                solve(numMoves + 1, cars, board, best, numCars, table);
                 moveBackward(cars[i], board);
             }
             
             if(moveBackward(cars[i], board)){
-                solve(numMoves +  1, cars, board, best, numCars, result);
+                solve(numMoves +  1, cars, board, best, numCars, table);
                 moveForward(cars[i], board);
             }
 
@@ -528,3 +644,441 @@ void solve(int numMoves, Vehicle cars[], int board[][MAX_ARR], int& best, const
     return;
     }
 }
+
+/**
+*boardKey  method that packs the lane offset of every vehicle into 3 bits of a key
+*
+*@return uint32_t a key that identifies the board
+*
+*@param cars an array containing every car on the board
+*
+*@param numCars number of cars currently on the board
+*
+**/
+uint32_t boardKey(const Vehicle cars[], const int& numCars){
+    uint32_t key = 0;
+    for(int i = 0; i < numCars; i++){
+        key |= (uint32_t)(isHorizontal(cars[i]) ? cars[i].column : cars[i].row) << (3 * i);
+    }
+    return key;
+}
+
+/**
+*visit  method that checks a board against the transposition table and records it.
+*A bucket keeps the shallowest entries: a new board replaces an empty or the deepest entry.
+*
+*@return VisitResult VISIT_SEEN if the board was already reached at an equal or smaller depth
+*
+*@param table the shared transposition table
+*
+*@param key the board's key
+*
+*@param depth the depth the board is reached at
+*
+*@post the table holds the board at depth unless VISIT_LOST was returned
+*
+**/
+VisitResult visit(TranspositionTable& table, const uint32_t key, const int depth){
+    uint64_t tag = (uint64_t)key + 1;
+    uint64_t entry = (tag << 32) | (uint32_t)depth;
+    size_t first = (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> (64 - TABLE_BITS)) & ~(size_t)(BUCKET - 1);
+    size_t victim = first;
+    uint64_t victimValue = table.entries[first].load(memory_order_relaxed);
+    for(size_t slot = first; slot < first + BUCKET; slot++){
+        uint64_t current = table.entries[slot].load(memory_order_relaxed);
+        if((current >> 32) == tag){
+            if((int)(uint32_t)current <= depth){
+                return VISIT_SEEN;
+            }
+            if(table.entries[slot].compare_exchange_strong(current, entry, memory_order_relaxed)){
+                return VISIT_STORED;
+            }
+            return VISIT_LOST;
+        }
+        //empty slots look deepest of all, so they are taken first
+        if(current == 0 || (victimValue != 0 && (uint32_t)current > (uint32_t)victimValue)){
+            victim = slot;
+            victimValue = current;
+        }
+    }
+    if(victimValue == 0 || (int)(uint32_t)victimValue > depth){
+        if(table.entries[victim].compare_exchange_strong(victimValue, entry, memory_order_relaxed) && victimValue == 0){
+            return VISIT_STORED;
+        }
+    }
+    return VISIT_LOST;
+}
+
+/**
+*improve  method that lowers the shared best score if numMoves beats it
+*
+*@return void
+*
+*@param best the best score thus far, shared by every thread
+*
+*@param numMoves moves used by a solution or a pruned branch
+*
+*@post best is the minimum of its old value and numMoves
+*
+**/
+void improve(atomic<int>& best, const int numMoves){
+    int current = best.load();
+    while(numMoves < current && !best.compare_exchange_weak(current, numMoves)){
+    }
+}
+
+/**
+*pushTask  method that queues a task on a thread's deque
+*
+*@return void
+*
+*@param pool the shared thread pool
+*
+*@param id the thread that owns the deque
+*
+*@param task board, cars and move count to search from
+*
+*@post the task is pending
+*
+**/
+void pushTask(Pool& pool, const int id, const Task& task){
+    pool.pending++;
+    lock_guard<mutex> guard(pool.deques[id].lock);
+    pool.deques[id].tasks.push_back(task);
+}
+
+/**
+*takeTask  method that pops the newest task of the thread's own deque, or steals the
+*oldest task of another thread when its own deque is empty
+*
+*@return bool indicating a task was found
+*
+*@param pool the shared thread pool
+*
+*@param id the calling thread
+*
+*@param task set to the task found
+*
+**/
+bool takeTask(Pool& pool, const int id, Task& task){
+    int numThreads = pool.deques.size();
+    for(int k = 0; k < numThreads; k++){
+        WorkDeque& victim = pool.deques[(id + k) % numThreads];
+        lock_guard<mutex> guard(victim.lock);
+        if(!victim.tasks.empty()){
+            if(k == 0){
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+            }
+            else{
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+*runTask  method that splits a shallow task into one task per move, or searches a deep
+*task in place with apply and undo on the task's own board
+*
+*@return void
+*
+*@param pool the shared thread pool
+*
+*@param id the calling thread
+*
+*@param task the task to run
+*
+*@post the task is no longer pending
+*
+**/
+void runTask(Pool& pool, const int id, Task& task){
+    if(task.numMoves < SPLIT_DEPTH && !isComplete(task.cars[0], task.board) &&
+       task.numMoves <= pool.best.load(memory_order_relaxed)){
+        for(int i = 0; i < pool.numCars; i++){
+            if(moveForward(task.cars[i], task.board)){
+                task.numMoves++;
+                pushTask(pool, id, task);
+                task.numMoves--;
+                moveBackward(task.cars[i], task.board);
+            }
+            if(moveBackward(task.cars[i], task.board)){
+                task.numMoves++;
+                pushTask(pool, id, task);
+                task.numMoves--;
+                moveForward(task.cars[i], task.board);
+            }
+        }
+    }
+    else{
+        solve(task.numMoves, task.cars, task.board, pool.best, pool.numCars, pool.table);
+    }
+    pool.pending--;
+}
+
+/**
+*work  method run by every thread until no task is queued or running
+*
+*@return void
+*
+*@param pool the shared thread pool
+*
+*@param id the calling thread
+*
+**/
+void work(Pool& pool, const int id){
+    Task task;
+    while(pool.pending > 0){
+        if(takeTask(pool, id, task)){
+            runTask(pool, id, task);
+        }
+        else{
+            this_thread::yield();
+        }
+    }
+}
+
+/**
+*solveParallel  method that searches the puzzle with a pool of work stealing threads
+*
+*@return void
+*
+*@param cars an array containing every car on the board
+*
+*@param board board that the game is played on
+*
+*@param best the bound to search under, lowered to the minimum moves if a solution is found
+*
+*@param numCars number of cars currently on the board
+*
+*@param numThreads number of threads to search with
+*
+*@pre vehicle v, 2d board
+*
+*@post best holds the minimum number of moves if it is below its starting value
+*
+**/
+void solveParallel(Vehicle cars[], int board[][MAX_ARR], atomic<int>& best, const int& numCars, const int numThreads){
+    Pool pool(numThreads);
+    pool.best = best.load();
+    pool.numCars = numCars;
+
+    Task root;
+    for(int i = 0; i < numCars; i++){
+        root.cars[i] = cars[i];
+    }
+    for(int i = 0; i < MAX_ARR * MAX_ARR; i++){
+        root.board[i / MAX_ARR][i % MAX_ARR] = board[i / MAX_ARR][i % MAX_ARR];
+    }
+    root.numMoves = 0;
+    pushTask(pool, 0, root);
+
+    vector<thread> threads;
+    for(int id = 1; id < numThreads; id++){
+        threads.push_back(thread(work, ref(pool), id));
+    }
+    work(pool, 0);
+    for(size_t i = 0; i < threads.size(); i++){
+        threads[i].join();
+    }
+    best = pool.best.load();
+}
+
+/**
+*clearTable  method that empties the transposition table
+*
+*@return void
+*
+*@param table the transposition table
+*
+*@post every entry is empty
+*
+**/
+void clearTable(TranspositionTable& table){
+    for(int i = 0; i < (1 << TABLE_BITS); i++){
+        table.entries[i] = 0;
+    }
+}
+
+/**
+*blockers  method that gives a lower bound on the moves left: the first car still has to
+*slide to the edge one square at a time and every vehicle in its way has to move at least once
+*
+*@return int admissible estimate of the moves needed
+*
+*@param cars an array containing every car on the board
+*
+*@param board board that the game is played on
+*
+**/
+int blockers(const Vehicle cars[], const int board[][MAX_ARR]){
+    const Vehicle& v = cars[0];
+    int estimate = 0;
+    int last = 0;
+    if(isHorizontal(v)){
+        estimate = MAX_ARR - v.length - v.column;
+        for(int c = v.column + v.length; c < MAX_ARR; c++){
+            if(board[v.row][c] != 0 && board[v.row][c] != last){
+                last = board[v.row][c];
+                estimate++;
+            }
+        }
+    }
+    else{
+        estimate = MAX_ARR - v.length - v.row;
+        for(int r = v.row + v.length; r < MAX_ARR; r++){
+            if(board[r][v.column] != 0 && board[r][v.column] != last){
+                last = board[r][v.column];
+                estimate++;
+            }
+        }
+    }
+    return estimate;
+}
+
+/**
+*unresolved  method that looks for a board that was cut off by the bound and never reached
+*again within it
+*
+*@return bool whether some entry is deeper than bound
+*
+*@param table the transposition table of a finished iteration
+*
+*@param bound the iteration's bound
+*
+**/
+bool unresolved(const TranspositionTable& table, const int bound){
+    for(int i = 0; i < (1 << TABLE_BITS); i++){
+        uint64_t entry = table.entries[i].load(memory_order_relaxed);
+        if(entry != 0 && (int)(uint32_t)entry > bound){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+*deepen  method that searches in place for a solution within bound moves, never undoing
+*the previous move straight away
+*
+*@return bool indicating a solution was found
+*
+*@param numMoves the number of moves currently used
+*
+*@param cars an array containing every car on the board
+*
+*@param board board that the game is played on
+*
+*@param bound the most moves a solution may use in this iteration
+*
+*@param numCars number of cars currently on the board
+*
+*@param lastMove the previous move as 2 * car for forward and 2 * car + 1 for backward, -1 at the root
+*
+*@param heuristic whether to add the blocker estimate to the moves used (IDA*)
+*
+*@param table boards already searched in this iteration with their estimate, or NULL
+*
+*@param nextBound lowered to the smallest estimate that went over bound
+*
+*@param lost counts boards the table could not keep
+*
+*@param moves set to the solution's length when one is found
+*
+*@pre vehicle v, 2d board
+*
+*@post cars and board are as they were before the call
+*
+**/
+bool deepen(int numMoves, Vehicle cars[], int board[][MAX_ARR], const int bound, const int& numCars, const int lastMove, const bool heuristic, TranspositionTable* table, int& nextBound, int& lost, int& moves){
+    int estimate = numMoves + (heuristic ? blockers(cars, board) : 0);
+    //the table keeps the estimate, which orders boards the same way as their depth; a board
+    //reached again with no smaller estimate is not a new cut off either
+    if(table != NULL){
+        VisitResult result = visit(*table, boardKey(cars, numCars), estimate);
+        if(result == VISIT_SEEN){
+            return false;
+        }
+        if(result == VISIT_LOST){
+            lost++;
+        }
+    }
+    if(estimate > bound){
+        if(estimate < nextBound){
+            nextBound = estimate;
+        }
+        return false;
+    }
+    if(isComplete(cars[0], board)){
+        moves = numMoves;
+        return true;
+    }
+    for(int i = 0; i < numCars; i++){
+        if(lastMove != 2 * i + 1 && moveForward(cars[i], board)){
+            bool found = deepen(numMoves + 1, cars, board, bound, numCars, 2 * i, heuristic, table, nextBound, lost, moves);
+            moveBackward(cars[i], board);
+            if(found){
+                return true;
+            }
+        }
+        if(lastMove != 2 * i && moveBackward(cars[i], board)){
+            bool found = deepen(numMoves + 1, cars, board, bound, numCars, 2 * i + 1, heuristic, table, nextBound, lost, moves);
+            moveForward(cars[i], board);
+            if(found){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+*solveDeepening  method that runs deepen with a rising bound until it finds a solution,
+*proves there is none, or passes maxDepth
+*
+*@return bool indicating a solution was found
+*
+*@param cars an array containing every car on the board
+*
+*@param board board that the game is played on
+*
+*@param numCars number of cars currently on the board
+*
+*@param heuristic whether to use the blocker estimate (IDA*)
+*
+*@param useTable whether to prune with a transposition table; without it memory only grows
+*with the depth but an unsolvable puzzle is only given up on at maxDepth
+*
+*@param maxDepth the longest solution to look for
+*
+*@param moves set to the minimum number of moves when a solution is found
+*
+*@pre vehicle v, 2d board
+*
+*@post cars and board are as they were before the call
+*
+**/
+bool solveDeepening(Vehicle cars[], int board[][MAX_ARR], const int& numCars, const bool heuristic, const bool useTable, const int maxDepth, int& moves){
+    unique_ptr<TranspositionTable> table(useTable ? new TranspositionTable : NULL);
+    int bound = heuristic ? blockers(cars, board) : 0;
+    while(bound <= maxDepth){
+        int nextBound = INT_MAX;
+        int lost = 0;
+        if(table){
+            clearTable(*table);
+        }
+        if(deepen(0, cars, board, bound, numCars, -1, heuristic, table.get(), nextBound, lost, moves)){
+            return true;
+        }
+        //every board cut off was later reached within the bound, so all reachable boards
+        //were searched (only trusted while the table kept every board)
+        if(nextBound == INT_MAX || (table && lost == 0 && !unresolved(*table, bound))){
+            return false;
+        }
+        bound = nextBound;
+    }
+    return false;
+}